@@ -0,0 +1,301 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <elf.h>
+#include "elf_file.h"
+#include "elf_common.h"
+#include "section.h"
+#include "symbol.h"
+#include "relocation.h"
+#include "synth_elf.h"
+
+extern char **environ;
+
+typedef struct
+{
+	const char *readelf; // Binaire readelf à mesurer
+	const char *fusion;  // Binaire fusion à mesurer
+	const char *dir;     // Répertoire des objets générés
+	unsigned runs;       // Nombre d'exécutions de chaque mesure (la meilleure est gardée)
+	Synth_Params p;      // Paramètres de chaque objet généré
+} Bench_Options;
+
+/* Modes d'affichage de readelf mesurés, sur les deux objets à la fois */
+static const struct
+{
+	const char *name;
+	const char *args[4];
+} readelf_modes[] =
+{
+	{ "readelf -h", { "-h", NULL       } },
+	{ "readelf -S", { "-S", NULL       } },
+	{ "readelf -s", { "-s", NULL       } },
+	{ "readelf -r", { "-r", NULL       } },
+	{ "readelf -x", { "-x", "1", NULL  } },
+	{ "readelf -A", { "-A", NULL       } },
+};
+
+static long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Exécute une commande, sa sortie standard étant jetée ou non ; retourne sa durée, ou -1 si elle a échoué */
+static long long time_command(char *argv[], int discard_output)
+{
+	posix_spawn_file_actions_t actions;
+	long long start;
+	pid_t pid;
+	int status;
+
+	posix_spawn_file_actions_init(&actions);
+	if(discard_output)
+		posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+	start = now_ns();
+	if(posix_spawn(&pid, argv[0], &actions, NULL, argv, environ) != 0)
+		status = -1;
+	else if(waitpid(pid, &status, 0) < 0)
+		status = -1;
+	start = now_ns() - start;
+
+	posix_spawn_file_actions_destroy(&actions);
+	return (WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? start : -1;
+}
+
+/* Affiche une colonne d'au moins width caractères ; les caractères UTF-8 accentués comptent pour un */
+static void print_column(const char *s, int width, int left)
+{
+	int len = 0;
+
+	for(const char *c = s; *c != '\0'; c++)
+		len += ((*c & 0xc0) != 0x80);
+	if(left)
+		printf("%s%*s", s, (len < width) ? width - len : 0, "");
+	else
+		printf("%*s%s", (len < width) ? width - len : 0, "", s);
+}
+
+static void print_result(const char *name, long long ns, unsigned nb_symbols, unsigned nb_relocations)
+{
+	if(ns < 0)
+	{
+		printf("  ");
+		print_column(name, 26, 1);
+		printf(" ");
+		print_column("échec", 12, 0);
+		printf("\n");
+		return;
+	}
+	printf("  ");
+	print_column(name, 26, 1);
+	printf(" %12.3f", ns / 1e6);
+	if(nb_symbols > 0)
+		printf(" %14.1f", (double) ns / nb_symbols);
+	else
+		printf(" %14s", "-");
+	if(nb_relocations > 0)
+		printf(" %18.1f\n", (double) ns / nb_relocations);
+	else
+		printf(" %18s\n", "-");
+}
+
+/* Mesure chaque étape de la lecture d'un objet par la bibliothèque, comme au début de fusion */
+static void bench_loading(const char *filename, const Bench_Options *o)
+{
+	const char *steps[] = { "lecture : en-tête", "lecture : sections", "lecture : symboles", "lecture : réimplantations" };
+	long long best[4] = { -1, -1, -1, -1 };
+
+	for(unsigned r = 0; r < o->runs; r++)
+	{
+		long long t[5];
+		Elf_File *ef;
+		Elf32_Ehdr *ehdr;
+		Section_Table *secTab;
+		symbolTable *st;
+		Data_Rel *drel;
+
+		t[0] = now_ns();
+		ef = open_elf_file(filename);
+		if(ef == NULL)
+			return;
+		ehdr   = read_elf_header(ef);
+		t[1]   = now_ns();
+		secTab = (ehdr != NULL) ? read_sectionTable(ef, ehdr) : NULL;
+		t[2]   = now_ns();
+		st     = (secTab != NULL) ? read_symbolTable(ef, secTab) : NULL;
+		t[3]   = now_ns();
+		drel   = (st != NULL) ? read_relocationTables(ef, secTab) : NULL;
+		t[4]   = now_ns();
+		if(drel == NULL)
+		{
+			fprintf(stderr, "%s : %s\n", filename, ef->error);
+			close_elf_file(ef);
+			return;
+		}
+
+		for(int s = 0; s < 4; s++)
+			if((best[s] < 0) || (t[s + 1] - t[s] < best[s]))
+				best[s] = t[s + 1] - t[s];
+
+		destroy_relocationTables(ef, drel);
+		destroy_symbolTable(st);
+		destroy_sectionTable(ef, secTab);
+		destroy_elf_header(ef, ehdr);
+		close_elf_file(ef);
+	}
+
+	for(int s = 0; s < 4; s++)
+		print_result(steps[s], best[s], o->p.nb_symbols, o->p.nb_relocations);
+}
+
+static long long best_of(char *argv[], unsigned runs)
+{
+	long long best = -1, t;
+
+	for(unsigned r = 0; r < runs; r++)
+	{
+		t = time_command(argv, 1);
+		if(t < 0)
+			return -1;
+		if((best < 0) || (t < best))
+			best = t;
+	}
+	return best;
+}
+
+static int run_benchmark(const Bench_Options *o)
+{
+	char file_a[4096], file_b[4096], file_out[4096];
+	Synth_Params pa = o->p, pb = o->p;
+	char *argv[8];
+	int n;
+
+	/* Deux objets qui se référencent l'un l'autre, pour que fusion résolve des symboles */
+	snprintf(file_a, sizeof(file_a), "%s/bench_a.o", o->dir);
+	snprintf(file_b, sizeof(file_b), "%s/bench_b.o", o->dir);
+	snprintf(file_out, sizeof(file_out), "%s/bench_out.o", o->dir);
+	pa.prefix = "a"; pa.undef_prefix = "b"; pa.seed = o->p.seed;
+	pb.prefix = "b"; pb.undef_prefix = "a"; pb.seed = o->p.seed + 1;
+	if(write_synthetic_elf(file_a, &pa) || write_synthetic_elf(file_b, &pb))
+	{
+		fprintf(stderr, "Impossible d'écrire les objets dans %s.\n", o->dir);
+		return 1;
+	}
+
+	printf("Objets : 2 x (%u sections, %u symboles, %u réimplantations), %s, meilleure de %u exécutions\n\n",
+		o->p.nb_sections, o->p.nb_symbols, o->p.nb_relocations, o->p.big_endian ? "gros-boutiste" : "petit-boutiste", o->runs);
+	printf("  ");
+	print_column("étape", 26, 1);
+	print_column("durée (ms)", 13, 0);
+	print_column("ns/symbole", 15, 0);
+	print_column("ns/réimplantation", 19, 0);
+	printf("\n");
+
+	bench_loading(file_a, o);
+
+	for(int m = 0; m < sizeof(readelf_modes) / sizeof(readelf_modes[0]); m++)
+	{
+		n = 0;
+		argv[n++] = (char *) o->readelf;
+		for(int a = 0; readelf_modes[m].args[a] != NULL; a++)
+			argv[n++] = (char *) readelf_modes[m].args[a];
+		argv[n++] = file_a;
+		argv[n++] = file_b;
+		argv[n]   = NULL;
+		print_result(readelf_modes[m].name, best_of(argv, o->runs), 2 * o->p.nb_symbols, 2 * o->p.nb_relocations);
+	}
+
+	argv[0] = (char *) o->fusion;
+	argv[1] = file_out;
+	argv[2] = file_a;
+	argv[3] = file_b;
+	argv[4] = NULL;
+	print_result("fusion", best_of(argv, o->runs), 2 * o->p.nb_symbols, 2 * o->p.nb_relocations);
+
+	/* Détail des étapes de fusion, mesurées par fusion elle-même */
+	printf("\nÉtapes de fusion :\n");
+	fflush(stdout);
+	argv[1] = "--stats";
+	argv[2] = file_out;
+	argv[3] = file_a;
+	argv[4] = file_b;
+	argv[5] = NULL;
+	time_command(argv, 0);
+	printf("\n");
+
+	return 0;
+}
+
+static void print_help(char *prgname)
+{
+	printf("Usage: %s -R readelf -F fusion [options]\n", prgname);
+	printf("Mesure readelf et fusion sur des objets ELF32 synthétiques\n");
+	printf("Les options sont :\n");
+	printf("  -R BINAIRE    Binaire readelf à mesurer\n");
+	printf("  -F BINAIRE    Binaire fusion à mesurer\n");
+	printf("  -d RÉPERTOIRE Répertoire des objets générés (défaut : .)\n");
+	printf("  -n N          Nombre de sections de code par objet (défaut : 500)\n");
+	printf("  -m M          Nombre de symboles par objet (défaut : 10000)\n");
+	printf("  -k K          Nombre de réimplantations par objet (défaut : 50000)\n");
+	printf("  -r R          Nombre d'exécutions de chaque mesure (défaut : 5)\n");
+	printf("  -b            Objets gros-boutistes\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int c;
+	Bench_Options o = { NULL, NULL, ".", 5, { 500, 10000, 50000, 0, "a", NULL, 1 } };
+
+	while((c = getopt(argc, argv, "R:F:d:n:m:k:r:b")) != -1)
+	{
+		switch(c)
+		{
+			case 'R':
+				o.readelf = optarg;
+				break;
+			case 'F':
+				o.fusion = optarg;
+				break;
+			case 'd':
+				o.dir = optarg;
+				break;
+			case 'n':
+				o.p.nb_sections = atoi(optarg);
+				break;
+			case 'm':
+				o.p.nb_symbols = atoi(optarg);
+				break;
+			case 'k':
+				o.p.nb_relocations = atoi(optarg);
+				break;
+			case 'r':
+				o.runs = (atoi(optarg) > 0) ? atoi(optarg) : 1;
+				break;
+			case 'b':
+				o.p.big_endian = 1;
+				break;
+			default:
+				print_help(argv[0]);
+				return 1;
+		}
+	}
+	if((o.readelf == NULL) || (o.fusion == NULL))
+	{
+		print_help(argv[0]);
+		return 1;
+	}
+
+	return run_benchmark(&o);
+}
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "synth_elf.h"
+
+static void print_help(char *prgname)
+{
+	printf("Usage: %s [options] fichier.o\n", prgname);
+	printf("Crée un objet ELF32 relogeable synthétique\n");
+	printf("Les options sont :\n");
+	printf("  -n N       Nombre de sections de code (défaut : 100)\n");
+	printf("  -m M       Nombre de symboles nommés (défaut : 1000)\n");
+	printf("  -k K       Nombre de réimplantations (défaut : 1000)\n");
+	printf("  -b         Crée un fichier gros-boutiste\n");
+	printf("  -p PRÉFIXE Préfixe des noms de symboles (défaut : a)\n");
+	printf("  -u PRÉFIXE Référence des symboles globaux définis par un objet de ce préfixe\n");
+	printf("  -s GRAINE  Graine du générateur pseudo-aléatoire\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int c;
+	Synth_Params p = { 100, 1000, 1000, 0, "a", NULL, 1 };
+
+	while((c = getopt(argc, argv, "n:m:k:bp:u:s:")) != -1)
+	{
+		switch(c)
+		{
+			case 'n':
+				p.nb_sections = atoi(optarg);
+				break;
+			case 'm':
+				p.nb_symbols = atoi(optarg);
+				break;
+			case 'k':
+				p.nb_relocations = atoi(optarg);
+				break;
+			case 'b':
+				p.big_endian = 1;
+				break;
+			case 'p':
+				p.prefix = optarg;
+				break;
+			case 'u':
+				p.undef_prefix = optarg;
+				break;
+			case 's':
+				p.seed = atoi(optarg);
+				break;
+			default:
+				print_help(argv[0]);
+				return 1;
+		}
+	}
+	if(optind != argc - 1)
+	{
+		print_help(argv[0]);
+		return 1;
+	}
+
+	if(write_synthetic_elf(argv[optind], &p))
+	{
+		fprintf(stderr, "Impossible d'écrire le fichier %s.\n", argv[optind]);
+		return 1;
+	}
+	return 0;
+}
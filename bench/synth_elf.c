@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+#include "synth_elf.h"
+
+#define ALIGN4(n) (((n) + 3) & ~(size_t) 3)
+
+typedef struct
+{
+	char *data;
+	size_t size;
+	size_t capacity;
+} Name_Buffer;
+
+typedef struct
+{
+	unsigned char *data; // Contenu du fichier
+	int big;             // Écrit les valeurs en gros-boutiste
+} Synth_File;
+
+/* Générateur xorshift : le même objet est produit pour la même graine */
+static uint32_t next_random(uint32_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static unsigned add_name(Name_Buffer *nb, const char *format, const char *prefix, unsigned i)
+{
+	unsigned offset = nb->size;
+	int n = snprintf(NULL, 0, format, prefix, i);
+
+	if(nb->size + n + 1 > nb->capacity)
+	{
+		nb->capacity = 2 * (nb->size + n + 1);
+		nb->data     = realloc(nb->data, nb->capacity);
+	}
+	snprintf(nb->data + nb->size, n + 1, format, prefix, i);
+	nb->size += n + 1;
+
+	return offset;
+}
+
+static void put16(Synth_File *sf, size_t offset, uint16_t v)
+{
+	unsigned char *p = sf->data + offset;
+
+	p[sf->big ? 0 : 1] = v >> 8;
+	p[sf->big ? 1 : 0] = v & 0xff;
+}
+
+static void put32(Synth_File *sf, size_t offset, uint32_t v)
+{
+	unsigned char *p = sf->data + offset;
+
+	for(int b = 0; b < 4; b++)
+		p[sf->big ? 3 - b : b] = (v >> (8 * b)) & 0xff;
+}
+
+static void put_shdr(Synth_File *sf, size_t offset, Elf32_Word name, Elf32_Word type, Elf32_Word flags, Elf32_Off data,
+                     Elf32_Word size, Elf32_Word link, Elf32_Word info, Elf32_Word align, Elf32_Word entsize)
+{
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_name),      name);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_type),      type);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_flags),     flags);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_addr),      0);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_offset),    data);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_size),      size);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_link),      link);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_info),      info);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_addralign), align);
+	put32(sf, offset + offsetof(Elf32_Shdr, sh_entsize),   entsize);
+}
+
+int write_synthetic_elf(const char *filename, const Synth_Params *p)
+{
+	const unsigned n = p->nb_sections;
+	const unsigned k = (n > 0) ? p->nb_relocations : 0;
+	const unsigned nb_locals = p->nb_symbols / 2;
+	const unsigned nb_undef  = (p->undef_prefix != NULL) ? p->nb_symbols / 10 : 0;
+	const unsigned nb_syms   = 1 + n + p->nb_symbols;
+	uint32_t state = p->seed ? p->seed : 1;
+	Name_Buffer strtab = { NULL, 0, 0 }, shstrtab = { NULL, 0, 0 };
+	unsigned *sym_name   = malloc(sizeof(unsigned) * nb_syms);
+	unsigned *text_name  = malloc(sizeof(unsigned) * (n + 1));
+	unsigned *rel_name   = malloc(sizeof(unsigned) * (n + 1));
+	unsigned *text_index = malloc(sizeof(unsigned) * (n + 1));
+	size_t *text_offset  = malloc(sizeof(size_t) * (n + 1));
+	size_t *rel_offset   = malloc(sizeof(size_t) * (n + 1));
+	unsigned symtab_name, strtab_name, shstrtab_name, shnum = 1, symtab_index;
+	size_t offset = sizeof(Elf32_Ehdr), symtab_offset, strtab_offset, shstrtab_offset, shoff;
+	Synth_File sf = { NULL, p->big_endian };
+	FILE *f;
+	int ret = 0;
+
+	/* Noms : la première entrée de chaque table est le nom vide */
+	add_name(&strtab, "%s", "", 0);
+	add_name(&shstrtab, "%s", "", 0);
+	symtab_name   = add_name(&shstrtab, "%s", ".symtab", 0);
+	strtab_name   = add_name(&shstrtab, "%s", ".strtab", 0);
+	shstrtab_name = add_name(&shstrtab, "%s", ".shstrtab", 0);
+
+	/* Chaque section de code est suivie de sa table de réimplantations, comme avec -ffunction-sections */
+	for(unsigned i = 0; i < n; i++)
+	{
+		unsigned nb_rel = k / n + (i < k % n);
+		size_t size = (4 * nb_rel > 16) ? 4 * nb_rel : 16;
+
+		text_index[i]  = shnum++;
+		text_offset[i] = offset;
+		offset += size;
+		rel_name[i]    = add_name(&shstrtab, ".rel%s.text.%u", "", i);
+		text_name[i]   = rel_name[i] + 4; // ".text.<i>" est la fin de ".rel.text.<i>"
+		if(nb_rel > 0)
+			shnum++;
+		rel_offset[i] = offset;
+		offset += nb_rel * sizeof(Elf32_Rel);
+	}
+	symtab_index = shnum;
+	shnum += 3;
+
+	for(unsigned i = 0; i <= n; i++)
+		sym_name[i] = 0;
+	for(unsigned j = 0; j < p->nb_symbols; j++)
+	{
+		if(j < nb_locals)
+			sym_name[1 + n + j] = add_name(&strtab, "%s_l%u", p->prefix, j);
+		else if(j < p->nb_symbols - nb_undef)
+			sym_name[1 + n + j] = add_name(&strtab, "%s_g%u", p->prefix, j - nb_locals);
+		else
+			sym_name[1 + n + j] = add_name(&strtab, "%s_g%u", p->undef_prefix, j - (p->nb_symbols - nb_undef));
+	}
+
+	symtab_offset   = ALIGN4(offset);
+	strtab_offset   = symtab_offset + (size_t) nb_syms * sizeof(Elf32_Sym);
+	shstrtab_offset = strtab_offset + strtab.size;
+	shoff           = ALIGN4(shstrtab_offset + shstrtab.size);
+	sf.data = calloc(1, shoff + (size_t) shnum * sizeof(Elf32_Shdr));
+
+	/* En-tête */
+	memcpy(sf.data, ELFMAG, SELFMAG);
+	sf.data[EI_CLASS]   = ELFCLASS32;
+	sf.data[EI_DATA]    = p->big_endian ? ELFDATA2MSB : ELFDATA2LSB;
+	sf.data[EI_VERSION] = EV_CURRENT;
+	put16(&sf, offsetof(Elf32_Ehdr, e_type),      ET_REL);
+	put16(&sf, offsetof(Elf32_Ehdr, e_machine),   EM_ARM);
+	put32(&sf, offsetof(Elf32_Ehdr, e_version),   EV_CURRENT);
+	put32(&sf, offsetof(Elf32_Ehdr, e_shoff),     shoff);
+	put32(&sf, offsetof(Elf32_Ehdr, e_flags),     EF_ARM_EABI_VER5);
+	put16(&sf, offsetof(Elf32_Ehdr, e_ehsize),    sizeof(Elf32_Ehdr));
+	put16(&sf, offsetof(Elf32_Ehdr, e_shentsize), sizeof(Elf32_Shdr));
+	put16(&sf, offsetof(Elf32_Ehdr, e_shnum),     shnum);
+	put16(&sf, offsetof(Elf32_Ehdr, e_shstrndx),  shnum - 1);
+
+	/* Sections de code et réimplantations ; les symboles visés sont tirés au hasard */
+	for(unsigned i = 0; i < n; i++)
+	{
+		size_t size = rel_offset[i] - text_offset[i];
+		unsigned nb_rel = k / n + (i < k % n);
+		size_t shdr = shoff + (size_t) text_index[i] * sizeof(Elf32_Shdr);
+
+		for(size_t b = 0; b < size; b += 4)
+			put32(&sf, text_offset[i] + b, next_random(&state));
+		for(unsigned r = 0; r < nb_rel; r++)
+		{
+			size_t rel = rel_offset[i] + (size_t) r * sizeof(Elf32_Rel);
+			put32(&sf, rel + offsetof(Elf32_Rel, r_offset), 4 * r);
+			put32(&sf, rel + offsetof(Elf32_Rel, r_info), ELF32_R_INFO(1 + next_random(&state) % (nb_syms - 1), R_ARM_ABS32));
+		}
+
+		put_shdr(&sf, shdr, text_name[i], SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, text_offset[i], size, 0, 0, 4, 0);
+		if(nb_rel > 0)
+			put_shdr(&sf, shdr + sizeof(Elf32_Shdr), rel_name[i], SHT_REL, SHF_INFO_LINK, rel_offset[i],
+			         nb_rel * sizeof(Elf32_Rel), symtab_index, text_index[i], 4, sizeof(Elf32_Rel));
+	}
+
+	/* Symboles : un symbole par section de code, puis les locaux, les globaux définis et les globaux non définis */
+	for(unsigned s = 1; s < nb_syms; s++)
+	{
+		size_t sym = symtab_offset + (size_t) s * sizeof(Elf32_Sym);
+		unsigned j = s - 1 - n, sec = (n > 0) ? next_random(&state) % n : 0;
+
+		put32(&sf, sym + offsetof(Elf32_Sym, st_name), sym_name[s]);
+		if(s <= n)
+		{
+			sf.data[sym + offsetof(Elf32_Sym, st_info)] = ELF32_ST_INFO(STB_LOCAL, STT_SECTION);
+			put16(&sf, sym + offsetof(Elf32_Sym, st_shndx), text_index[s - 1]);
+			continue;
+		}
+		if((j >= p->nb_symbols - nb_undef) || (n == 0))
+		{
+			sf.data[sym + offsetof(Elf32_Sym, st_info)] = ELF32_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+			continue;
+		}
+		sf.data[sym + offsetof(Elf32_Sym, st_info)] = ELF32_ST_INFO((j < nb_locals) ? STB_LOCAL : STB_GLOBAL, STT_FUNC);
+		put32(&sf, sym + offsetof(Elf32_Sym, st_value), 4 * (next_random(&state) % ((rel_offset[sec] - text_offset[sec]) / 4)));
+		put32(&sf, sym + offsetof(Elf32_Sym, st_size),  4);
+		put16(&sf, sym + offsetof(Elf32_Sym, st_shndx), text_index[sec]);
+	}
+	memcpy(sf.data + strtab_offset, strtab.data, strtab.size);
+	memcpy(sf.data + shstrtab_offset, shstrtab.data, shstrtab.size);
+
+	put_shdr(&sf, shoff + (size_t) symtab_index * sizeof(Elf32_Shdr), symtab_name, SHT_SYMTAB, 0, symtab_offset,
+	         nb_syms * sizeof(Elf32_Sym), symtab_index + 1, 1 + n + nb_locals, 4, sizeof(Elf32_Sym));
+	put_shdr(&sf, shoff + (size_t) (symtab_index + 1) * sizeof(Elf32_Shdr), strtab_name, SHT_STRTAB, 0, strtab_offset,
+	         strtab.size, 0, 0, 1, 0);
+	put_shdr(&sf, shoff + (size_t) (symtab_index + 2) * sizeof(Elf32_Shdr), shstrtab_name, SHT_STRTAB, 0, shstrtab_offset,
+	         shstrtab.size, 0, 0, 1, 0);
+
+	f = fopen(filename, "wb");
+	if((f == NULL) || (fwrite(sf.data, 1, shoff + (size_t) shnum * sizeof(Elf32_Shdr), f) != shoff + (size_t) shnum * sizeof(Elf32_Shdr)))
+		ret = -1;
+	if((f != NULL) && fclose(f))
+		ret = -1;
+
+	free(sf.data);
+	free(strtab.data);
+	free(shstrtab.data);
+	free(sym_name);
+	free(text_name);
+	free(rel_name);
+	free(text_index);
+	free(text_offset);
+	free(rel_offset);
+
+	return ret;
+}
@@ -0,0 +1,27 @@
+#ifndef _SYNTH_ELF_H_
+#define _SYNTH_ELF_H_
+
+typedef struct
+{
+	unsigned nb_sections;     // Nombre de sections de code (N)
+	unsigned nb_symbols;      // Nombre de symboles nommés (M)
+	unsigned nb_relocations;  // Nombre de réimplantations (K), réparties entre les sections de code
+	int big_endian;           // 1 pour un fichier gros-boutiste
+	const char *prefix;       // Préfixe des noms de symboles, différent pour chaque objet d'une même fusion
+	const char *undef_prefix; // Préfixe des symboles d'un autre objet référencés (non définis) ici, ou NULL
+	unsigned seed;            // Graine du générateur pseudo-aléatoire (contenu, valeurs, cibles)
+} Synth_Params;
+
+/**
+ * Écrit un objet ELF32 relogeable (ARM) synthétique : N sections .text.<i>, chacune suivie
+ * si besoin de sa table .rel.text.<i>, une table des symboles (symboles de section, puis
+ * M symboles nommés, locaux d'abord), et les tables de noms
+ *
+ * @param filename: le fichier à créer
+ * @param p:        les paramètres de l'objet
+ * @retourne 0 en cas de succès, -1 si le fichier n'a pas pu être écrit
+ **/
+int write_synthetic_elf(const char *filename, const Synth_Params *p);
+
+
+#endif
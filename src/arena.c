@@ -0,0 +1,135 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+/* Alignement des zones distribuées, suffisant pour tous les types de base */
+#define ARENA_ALIGN 16
+#define ALIGN_UP(n) (((n) + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1))
+
+/* Les données d'un bloc suivent son en-tête */
+#define BLOCK_DATA(b) ((unsigned char *) (b) + ALIGN_UP(sizeof(Arena_Block)))
+
+Arena *create_arena(size_t block_size)
+{
+	Arena *a = malloc(sizeof(Arena));
+
+	a->block       = NULL;
+	a->block_size  = ALIGN_UP(block_size);
+	a->used        = 0;
+	a->reserved    = 0;
+	a->peak        = 0;
+	a->allocations = 0;
+	a->allocated   = 0;
+	a->last        = NULL;
+
+	return a;
+}
+
+void *arena_alloc(Arena *a, size_t size)
+{
+	Arena_Block *b;
+	void *p;
+
+	if(a == NULL)
+		return malloc(size);
+
+	size = ALIGN_UP(size);
+	b    = a->block;
+	if((b == NULL) || (b->used + size > b->size))
+	{
+		/* Une grande zone occupe un bloc à elle seule ; la fin du bloc précédent est perdue */
+		b = malloc(ALIGN_UP(sizeof(Arena_Block)) + ((size > a->block_size) ? size : a->block_size));
+		b->prev = a->block;
+		b->size = (size > a->block_size) ? size : a->block_size;
+		b->used = 0;
+		a->block     = b;
+		a->reserved += b->size;
+	}
+
+	p = BLOCK_DATA(b) + b->used;
+	b->used += size;
+	a->used += size;
+	a->last  = p;
+	a->allocations++;
+	a->allocated += size;
+	if(a->used > a->peak)
+		a->peak = a->used;
+
+	return p;
+}
+
+void *arena_calloc(Arena *a, size_t n, size_t size)
+{
+	if(a == NULL)
+		return calloc(n, size);
+
+	return memset(arena_alloc(a, n * size), 0, n * size);
+}
+
+void *arena_realloc(Arena *a, void *p, size_t old_size, size_t new_size)
+{
+	Arena_Block *b;
+	void *q;
+
+	if(a == NULL)
+		return realloc(p, new_size);
+	if(p == NULL)
+		return arena_alloc(a, new_size);
+
+	/* La dernière zone allouée s'étend jusqu'à la fin de la partie distribuée du bloc */
+	b = a->block;
+	if((p == a->last) && (b->used - ALIGN_UP(old_size) + ALIGN_UP(new_size) <= b->size))
+	{
+		b->used += ALIGN_UP(new_size) - ALIGN_UP(old_size);
+		a->used += ALIGN_UP(new_size) - ALIGN_UP(old_size);
+		if(new_size > old_size)
+			a->allocated += ALIGN_UP(new_size) - ALIGN_UP(old_size);
+		if(a->used > a->peak)
+			a->peak = a->used;
+		return p;
+	}
+
+	q = arena_alloc(a, new_size);
+	memcpy(q, p, (old_size < new_size) ? old_size : new_size);
+	return q;
+}
+
+void arena_free(Arena *a, void *p)
+{
+	if(a == NULL)
+		free(p);
+}
+
+Arena_Mark get_arena_mark(Arena *a)
+{
+	return (Arena_Mark) { a->block, (a->block != NULL) ? a->block->used : 0, a->used };
+}
+
+void release_arena(Arena *a, Arena_Mark mark)
+{
+	Arena_Block *b;
+
+	while(a->block != mark.block)
+	{
+		b = a->block;
+		a->block     = b->prev;
+		a->reserved -= b->size;
+		free(b);
+	}
+	if(a->block != NULL)
+		a->block->used = mark.block_used;
+	a->used = mark.used;
+	a->last = NULL;
+}
+
+void reset_arena_peak(Arena *a)
+{
+	a->peak = a->used;
+}
+
+void destroy_arena(Arena *a)
+{
+	release_arena(a, (Arena_Mark) { NULL, 0, 0 });
+	free(a);
+}
@@ -0,0 +1,112 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stddef.h>
+
+typedef struct Arena_Block
+{
+	struct Arena_Block *prev; // Bloc alloué avant celui-ci
+	size_t size;              // Taille utilisable du bloc
+	size_t used;              // Taille déjà distribuée dans le bloc
+} Arena_Block;
+
+typedef struct
+{
+	Arena_Block *block;        // Bloc courant (le dernier alloué)
+	size_t block_size;         // Taille minimale d'un bloc
+	size_t used;               // Nombre d'octets distribués
+	size_t reserved;           // Nombre d'octets alloués pour les blocs
+	size_t peak;               // Maximum de used depuis le dernier appel à reset_arena_peak
+	unsigned long allocations; // Nombre de zones distribuées
+	size_t allocated;          // Nombre d'octets distribués depuis la création (used sans les libérations)
+	void *last;                // Dernière allocation, qui peut être agrandie sur place
+} Arena;
+
+typedef struct
+{
+	Arena_Block *block; // Bloc courant au moment de la marque
+	size_t block_used;  // Taille distribuée dans ce bloc
+	size_t used;        // Nombre d'octets distribués par l'arène
+} Arena_Mark;
+
+/**
+ * Crée une arène vide : les allocations sont faites en avançant un pointeur dans de grands
+ * blocs, et ne sont libérées qu'ensemble, par destroy_arena (ou release_arena)
+ *
+ * @param block_size: la taille minimale des blocs demandés au système
+ * @retourne un pointeur sur une structure de type Arena
+ **/
+Arena *create_arena(size_t block_size);
+
+/**
+ * Alloue une zone dans une arène ; sans arène (NULL), la zone est allouée avec malloc
+ *
+ * @param a:    une structure de type Arena initialisée, ou NULL
+ * @param size: la taille de la zone
+ * @retourne un pointeur sur la zone
+ **/
+void *arena_alloc(Arena *a, size_t size);
+
+/**
+ * Alloue une zone remplie de zéros dans une arène ; sans arène (NULL), la zone est allouée avec calloc
+ *
+ * @param a:    une structure de type Arena initialisée, ou NULL
+ * @param n:    le nombre d'éléments
+ * @param size: la taille d'un élément
+ * @retourne un pointeur sur la zone
+ **/
+void *arena_calloc(Arena *a, size_t n, size_t size);
+
+/**
+ * Agrandit ou réduit une zone allouée dans une arène. La dernière zone allouée est
+ * agrandie sur place quand le bloc le permet ; sinon la zone est recopiée
+ *
+ * @param a:        une structure de type Arena initialisée, ou NULL (realloc)
+ * @param p:        la zone à redimensionner, ou NULL
+ * @param old_size: la taille actuelle de la zone
+ * @param new_size: la nouvelle taille de la zone
+ * @retourne un pointeur sur la zone redimensionnée
+ **/
+void *arena_realloc(Arena *a, void *p, size_t old_size, size_t new_size);
+
+/**
+ * Libère une zone : sans arène, la zone est libérée avec free ; dans une arène, elle
+ * ne l'est qu'avec l'arène
+ *
+ * @param a: une structure de type Arena initialisée, ou NULL
+ * @param p: la zone à libérer
+ **/
+void arena_free(Arena *a, void *p);
+
+/**
+ * Retourne une marque de l'état de l'arène, pour libérer ensuite les zones temporaires
+ *
+ * @param a: une structure de type Arena initialisée
+ * @retourne la marque
+ **/
+Arena_Mark get_arena_mark(Arena *a);
+
+/**
+ * Libère toutes les zones allouées dans une arène depuis une marque
+ *
+ * @param a:    une structure de type Arena initialisée
+ * @param mark: une marque retournée par get_arena_mark sur cette arène
+ **/
+void release_arena(Arena *a, Arena_Mark mark);
+
+/**
+ * Recommence la mesure du pic d'utilisation d'une arène à partir de son utilisation actuelle
+ *
+ * @param a: une structure de type Arena initialisée
+ **/
+void reset_arena_peak(Arena *a);
+
+/**
+ * Libère une arène et toutes les zones qui y ont été allouées
+ *
+ * @param a: une structure de type Arena initialisée
+ **/
+void destroy_arena(Arena *a);
+
+
+#endif
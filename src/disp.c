@@ -13,6 +13,8 @@
 #include "section.h"
 #include "symbol.h"
 #include "relocation.h"
+#include "text_buffer.h"
+#include "hexdump.h"
 
 #include "type_strings.h"
 
@@ -25,9 +27,9 @@ const char *get_type_string(const Types t[], Elf32_Word index)
     return t[i].string;
 }
 
-char *get_eflags_as_string(Elf32_Half machine, Elf32_Word flags)
+char *get_eflags_as_string(Elf32_Half machine, Elf32_Word flags, char str[64])
 {
-    static char str[64] = "";
+    str[0] = '\0';
 
     if(machine == EM_ARM)
     {
@@ -42,80 +44,59 @@ char *get_eflags_as_string(Elf32_Half machine, Elf32_Word flags)
     return str;
 }
 
-void dump_header(Elf32_Ehdr *ehdr)
+void dump_header(Text_Buffer *out, Elf32_Ehdr *ehdr)
 {
-    printf("En-tête ELF:\n");
-    printf("  %-11s", "Magique:");
+    char eflags[64];
+
+    append_format(out, "En-tête ELF:\n");
+    append_format(out, "  %-11s", "Magique:");
     for(int i = 0; i < EI_NIDENT; i++)
-        printf("%02x ", ehdr->e_ident[i]);
-
-    printf("\n  %-35s%s\n", "Classe:", get_type_string(elfclass, ehdr->e_ident[EI_CLASS]));
-    printf("  %-35s %s\n", "Données:",  get_type_string(elfdata, ehdr->e_ident[EI_DATA]));
-    printf("  %-35s%i %s\n", "Version:",  ehdr->e_ident[EI_VERSION], (ehdr->e_ident[EI_VERSION] == EV_CURRENT) ? "(current)" : "");
-    printf("  %-35s%s\n", "OS/ABI:",   get_type_string(elfosabi, ehdr->e_ident[EI_OSABI]));
-    printf("  %-35s%i\n", "Version ABI:", ehdr->e_ident[EI_ABIVERSION]);
-    printf("  %-35s%s\n", "Type:",     get_type_string(et, ehdr->e_type));
-    printf("  %-35s%s\n", "Machine:",  get_type_string(em, ehdr->e_machine));
-    printf("  %-35s%#x\n", "Version:", ehdr->e_version);
-    printf("  %-35s 0x%x\n", "Adresse du point d'entrée:", ehdr->e_entry);
-    printf("  %-35s %2i (octets dans le fichier)\n", "Début des en-têtes de programme:", ehdr->e_phoff);
-    printf("  %-35s%8i (octets dans le fichier)\n", "Début des en-têtes de section:", ehdr->e_shoff);
-    printf("  %-35s%#x, %s\n", "Fanions:", ehdr->e_flags, get_eflags_as_string(ehdr->e_machine, ehdr->e_flags));
-    printf("  %-35s %i (octets)\n","Taille de cet en-tête:", ehdr->e_ehsize);
-    printf("  %-35s %i (octets)\n","Taille de l'en-tête du programme:", ehdr->e_phentsize);
-    printf("  %-35s %i\n","Nombre d'en-tête du programme:", ehdr->e_phnum);
-    printf("  %-35s %i (octets)\n","Taille des en-têtes de section:", ehdr->e_shentsize);
-    printf("  %-35s %i\n","Nombre d'en-têtes de section:", ehdr->e_shnum);
-    printf("  %-35s %i\n","Table d'indexes des chaînes d'en-tête de section:", ehdr->e_shstrndx);
+    {
+        append_hex(out, ehdr->e_ident[i], 2);
+        append_char(out, ' ');
+    }
+
+    append_format(out, "\n  %-35s%s\n", "Classe:", get_type_string(elfclass, ehdr->e_ident[EI_CLASS]));
+    append_format(out, "  %-35s %s\n", "Données:",  get_type_string(elfdata, ehdr->e_ident[EI_DATA]));
+    append_format(out, "  %-35s%i %s\n", "Version:",  ehdr->e_ident[EI_VERSION], (ehdr->e_ident[EI_VERSION] == EV_CURRENT) ? "(current)" : "");
+    append_format(out, "  %-35s%s\n", "OS/ABI:",   get_type_string(elfosabi, ehdr->e_ident[EI_OSABI]));
+    append_format(out, "  %-35s%i\n", "Version ABI:", ehdr->e_ident[EI_ABIVERSION]);
+    append_format(out, "  %-35s%s\n", "Type:",     get_type_string(et, ehdr->e_type));
+    append_format(out, "  %-35s%s\n", "Machine:",  get_type_string(em, ehdr->e_machine));
+    append_format(out, "  %-35s%#x\n", "Version:", ehdr->e_version);
+    append_format(out, "  %-35s 0x%x\n", "Adresse du point d'entrée:", ehdr->e_entry);
+    append_format(out, "  %-35s %2i (octets dans le fichier)\n", "Début des en-têtes de programme:", ehdr->e_phoff);
+    append_format(out, "  %-35s%8i (octets dans le fichier)\n", "Début des en-têtes de section:", ehdr->e_shoff);
+    append_format(out, "  %-35s%#x, %s\n", "Fanions:", ehdr->e_flags, get_eflags_as_string(ehdr->e_machine, ehdr->e_flags, eflags));
+    append_format(out, "  %-35s %i (octets)\n","Taille de cet en-tête:", ehdr->e_ehsize);
+    append_format(out, "  %-35s %i (octets)\n","Taille de l'en-tête du programme:", ehdr->e_phentsize);
+    append_format(out, "  %-35s %i\n","Nombre d'en-tête du programme:", ehdr->e_phnum);
+    append_format(out, "  %-35s %i (octets)\n","Taille des en-têtes de section:", ehdr->e_shentsize);
+    append_format(out, "  %-35s %i\n","Nombre d'en-têtes de section:", ehdr->e_shnum);
+    append_format(out, "  %-35s %i\n","Table d'indexes des chaînes d'en-tête de section:", ehdr->e_shstrndx);
 }
 
 
 // SECTION
-void dump_section (int fd, Section_Table *secTab, unsigned index){
-
-    printf("\nAffichage hexadécimal de la section « %s » :\n\n", get_section_name(secTab, index));
+void dump_section (Text_Buffer *out, Elf_File *ef, Section_Table *secTab, unsigned index){
 
     Elf32_Shdr *shdrToDisplay = secTab->shdr[index];
+    const unsigned char *data = get_elf_view(ef, shdrToDisplay->sh_offset, shdrToDisplay->sh_size);
 
-    unsigned char buffer, line[BYTES_COUNT];
+    if ((shdrToDisplay->sh_type == SHT_NOBITS) || (data == NULL)){
+        append_format(out, "\nLa section « %s » n'a pas de données à afficher.\n", get_section_name(secTab, index));
+        return;
+    }
 
-    lseek(fd, shdrToDisplay->sh_offset , SEEK_SET);
+    append_format(out, "\nAffichage hexadécimal de la section « %s » :\n\n", get_section_name(secTab, index));
 
-    int i;
-    int j;
-    int k;
-    for (i=0; i<shdrToDisplay->sh_size;){
-        memset(line, ' ', BYTES_COUNT); // Simplifie l'affichage en ASCII si (i % BYTES_COUNT) != 0
-        printf("  0x%08x ", i + shdrToDisplay->sh_addr);
-
-        for (j=0; j<BLOCKS_COUNT; j++){
-
-            for (k=0; k<BYTES_PER_BLOCK; k++){
-                if ( i < shdrToDisplay->sh_size ){
-                    read(fd, &buffer, 1);
-                    line[i%BYTES_COUNT] = buffer;
-                    printf("%02x", buffer);
-                    i++;
-                }
-                else{
-                    printf("  ");
-                }
-            }
-            printf(" ");
-        }
-
-        for(j=0; j<BYTES_COUNT; j++){
-            printf("%c", isprint(line[j]) ? line[j] : '.');
-        }
-        printf("\n");
-    }
+    hexdump_to_text_buffer(out, data, shdrToDisplay->sh_size, shdrToDisplay->sh_addr);
 }
 
-// static char *flags_to_string(Elf32_Word flags)
-char *flags_to_string(Elf32_Word flags)
+// static char *flags_to_string(Elf32_Word flags, char buff[10])
+char *flags_to_string(Elf32_Word flags, char buff[10])
 {
-    static char buff[3];
-    memset(buff, 0, 3);
+    buff[0] = '\0';
 
     if(flags & SHF_WRITE)
         strcat(buff, "W");
@@ -139,77 +120,101 @@ char *flags_to_string(Elf32_Word flags)
     return buff;
 }
 
-void dump_section_header(Section_Table *secTab, Elf32_Off offset)
+void dump_section_header(Text_Buffer *out, Section_Table *secTab, Elf32_Off offset)
 {
-    printf("Il y a %i en-têtes de section, débutant à l'adresse de décalage %#x:\n\n", secTab->nb_sections, offset);
-    printf("En-têtes de section :\n");
-    printf("  [%2s] %-18s %-14s  %-8s %6s %-6s %2s %2s %2s %2s %2s\n",
+    char flags[10]; // Une lettre par fanion connu
+    append_format(out, "Il y a %i en-têtes de section, débutant à l'adresse de décalage %#x:\n\n", secTab->nb_sections, offset);
+    append_str(out, "En-têtes de section :\n");
+    append_format(out, "  [%2s] %-18s %-14s  %-8s %6s %-6s %2s %2s %2s %2s %2s\n",
         "Nr", "Nom", "Type", "Adr", "Décala.", "Taille", "ES", "Fan", "LN", "Inf", "Al");
 
+    /* "  [%2i] %-18s %-14s  %08x %06x %06x %02x  %2s %2i  %2i %2i\n" */
     for(int i = 0; i < secTab->nb_sections; i++)
-        printf("  [%2i] %-18s %-14s  %08x %06x %06x %02x  %2s %2i  %2i %2i\n", i,
-            get_section_name(secTab, i),
-            get_type_string(sht, secTab->shdr[i]->sh_type),
-            secTab->shdr[i]->sh_addr,
-            secTab->shdr[i]->sh_offset,
-            secTab->shdr[i]->sh_size,
-            secTab->shdr[i]->sh_entsize,
-            flags_to_string(secTab->shdr[i]->sh_flags),
-            secTab->shdr[i]->sh_link,
-            secTab->shdr[i]->sh_info,
-            secTab->shdr[i]->sh_addralign);
-    printf("Liste des fanions :\n");
-    printf("  W : écriture\n");
-    printf("  A : allocation\n");
-    printf("  X : exécution\n");
-    printf("  M : fusion\n");
-    printf("  S : chaînes\n");
-    printf("  I : info\n");
-    printf("  L : ordre des liens\n");
-    printf("  G : groupes\n");
-    printf("  T : TLS\n");
+    {
+        Elf32_Shdr *shdr = secTab->shdr[i];
+
+        append_str(out, "  [");
+        append_dec(out, i, 2);
+        append_str(out, "] ");
+        append_padded(out, get_section_name(secTab, i), -18);
+        append_char(out, ' ');
+        append_padded(out, get_type_string(sht, shdr->sh_type), -14);
+        append_str(out, "  ");
+        append_hex(out, shdr->sh_addr, 8);
+        append_char(out, ' ');
+        append_hex(out, shdr->sh_offset, 6);
+        append_char(out, ' ');
+        append_hex(out, shdr->sh_size, 6);
+        append_char(out, ' ');
+        append_hex(out, shdr->sh_entsize, 2);
+        append_str(out, "  ");
+        append_padded(out, flags_to_string(shdr->sh_flags, flags), 2);
+        append_char(out, ' ');
+        append_dec(out, shdr->sh_link, 2);
+        append_str(out, "  ");
+        append_dec(out, shdr->sh_info, 2);
+        append_char(out, ' ');
+        append_dec(out, shdr->sh_addralign, 2);
+        append_char(out, '\n');
+    }
+    append_str(out, "Liste des fanions :\n"
+                    "  W : écriture\n"
+                    "  A : allocation\n"
+                    "  X : exécution\n"
+                    "  M : fusion\n"
+                    "  S : chaînes\n"
+                    "  I : info\n"
+                    "  L : ordre des liens\n"
+                    "  G : groupes\n"
+                    "  T : TLS\n");
 }
 
 
 // SYMBOL
-void dump_symtab(Symtab_Struct *s) {
+void dump_symtab(Text_Buffer *out, Symtab_Struct *s) {
     char *STT_VAL[]={"NOTYPE","OBJECT","FUNC","SECTION","FILE","COMMON","TLS"};
     char *STB_VAL[]={"LOCAL","GLOBAL","WEAK"};
 
     int i = 1;
 
-    printf("\nTable de symboles « %s » contient %i entrées :\n", s->name, s->nbSymbol);
-    printf("   Num:    Valeur Tail Type    Lien   Vis      Ndx Nom\n");
+    append_format(out, "\nTable de symboles « %s » contient %i entrées :\n", s->name, s->nbSymbol);
+    append_str(out, "   Num:    Valeur Tail Type    Lien   Vis      Ndx Nom\n");
     for (i = 0; i < s->nbSymbol; ++i) {
-        printf("%6d: ", i);
-        printf("%08x ", s->tab[i]->st_value);
-        printf("%5d ", s->tab[i]->st_size);
-        printf("%-7s ", STT_VAL[ELF32_ST_TYPE(s->tab[i]->st_info)]);
-        printf("%-6s ", STB_VAL[ELF32_ST_BIND(s->tab[i]->st_info)]);
-        printf("DEFAULT  "); // TODO: Gerer les differentes possibilités (DEFAULT,HIDDEN,PROTECTED)
-
-        switch(s->tab[i]->st_shndx) {
+        append_dec(out, i, 6);
+        append_str(out, ": ");
+        append_hex(out, s->tab[i].st_value, 8);
+        append_char(out, ' ');
+        append_dec(out, s->tab[i].st_size, 5);
+        append_char(out, ' ');
+        append_padded(out, STT_VAL[ELF32_ST_TYPE(s->tab[i].st_info)], -7);
+        append_char(out, ' ');
+        append_padded(out, STB_VAL[ELF32_ST_BIND(s->tab[i].st_info)], -6);
+        append_char(out, ' ');
+        append_str(out, "DEFAULT  "); // TODO: Gerer les differentes possibilités (DEFAULT,HIDDEN,PROTECTED)
+
+        switch(s->tab[i].st_shndx) {
             case SHN_UNDEF:
-                printf("UND ");
+                append_str(out, "UND ");
                 break;
             case SHN_ABS:
-                printf("ABS ");
+                append_str(out, "ABS ");
                 break;
 
             default:
-                printf("%3i ", s->tab[i]->st_shndx);
+                append_dec(out, s->tab[i].st_shndx, 3);
+                append_char(out, ' ');
         }
-        printf("%-10s ", get_symbol_name(s->tab,s->symbolNameTable,i));
-        printf("\n");
+        append_padded(out, get_symbol_name(s->tab,s->symbolNameTable,i), -10);
+        append_str(out, " \n");
     }
 }
 
-void displ_symbolTable(symbolTable *st) {
+void displ_symbolTable(Text_Buffer *out, symbolTable *st) {
     if (st->dynsym->nbSymbol > 0) {
-        dump_symtab(st->dynsym);
+        dump_symtab(out, st->dynsym);
     }
     if (st->symtab->nbSymbol > 0) {
-        dump_symtab(st->symtab);
+        dump_symtab(out, st->symtab);
     }
 }
 
@@ -249,36 +254,43 @@ const char *relocation_type_to_string(Elf32_Half machine, Elf32_Word type)
     return (m[i].machine == machine) ? get_type_string(m[i].type, type) : "Inconnu";
 }
 
-void dump_relocation_type(Elf32_Ehdr *ehdr, Section_Table *secTab, symbolTable *symTabFull, Data_Rel *drel, int is_rela)
+void dump_relocation_type(Text_Buffer *out, Elf32_Ehdr *ehdr, Section_Table *secTab, symbolTable *symTabFull, Data_Rel *drel, int is_rela)
 {
-    unsigned nb_rel   = (!is_rela) ? drel->nb_rel : drel->nb_rela;
-    unsigned *e_rel   = (!is_rela) ? drel->e_rel  : drel->e_rela;
-    unsigned *i_rel   = (!is_rela) ? drel->i_rel  : drel->i_rela;
-    Elf32_Addr *a_rel = (!is_rela) ? drel->a_rel  : drel->a_rela;
-    Elf32_Rela ***rel = (!is_rela) ? (Elf32_Rela ***) drel->rel : drel->rela;
+    unsigned nb_rel = (!is_rela) ? drel->nb_rel : drel->nb_rela;
+    Rel_Section *s  = (!is_rela) ? drel->rel    : drel->rela;
+    const Elf32_Rel *rel;
 
     for(int i = 0; i < nb_rel; i++)
     {
-        printf("\nSection de réadressage '%s' à l'adresse de décalage %#x contient %u entrées:\n",
-            get_section_name(secTab, i_rel[i]), a_rel[i], e_rel[i]);
-        printf(" %-8s   %-8s%-16s%-8s  %s%s\n", "Décalage", "Info", "Type", "Val.-sym", "Noms-symboles", is_rela ? "+ Addenda" : "");
-        for(int j = 0; j < e_rel[i]; j++)
+        append_format(out, "\nSection de réadressage '%s' à l'adresse de décalage %#x contient %u entrées:\n",
+            get_section_name(secTab, s[i].index), s[i].offset, s[i].nb_entries);
+        append_format(out, " %-8s   %-8s%-16s%-8s  %s%s\n", "Décalage", "Info", "Type", "Val.-sym", "Noms-symboles", is_rela ? "+ Addenda" : "");
+        for(int j = 0; j < s[i].nb_entries; j++)
         {
-            printf("%08x  %08x %-16s  %08x   %s",
-                rel[i][j]->r_offset,
-                rel[i][j]->r_info,
-                relocation_type_to_string(ehdr->e_machine, ELF32_R_TYPE(rel[i][j]->r_info)),
-                get_symbol_value_generic(symTabFull, rel[i][j]->r_info),
-                get_symbol_or_section_name(secTab, symTabFull, rel[i][j]->r_info));
+            /* Elf32_Rela commence par les mêmes champs que Elf32_Rel */
+            rel = (!is_rela) ? &s[i].rel[j] : (const Elf32_Rel *) &s[i].rela[j];
+            /* "%08x  %08x %-16s  %08x   %s" */
+            append_hex(out, rel->r_offset, 8);
+            append_str(out, "  ");
+            append_hex(out, rel->r_info, 8);
+            append_char(out, ' ');
+            append_padded(out, relocation_type_to_string(ehdr->e_machine, ELF32_R_TYPE(rel->r_info)), -16);
+            append_str(out, "  ");
+            append_hex(out, get_symbol_value_generic(symTabFull, rel->r_info), 8);
+            append_str(out, "   ");
+            append_str(out, get_symbol_or_section_name(secTab, symTabFull, rel->r_info));
             if(is_rela)
-                printf(" + %i", rel[i][j]->r_addend);
-            printf("\n");
+            {
+                append_str(out, " + ");
+                append_dec(out, s[i].rela[j].r_addend, 0);
+            }
+            append_char(out, '\n');
         }
     }
 }
 
-void dump_relocation(Elf32_Ehdr *ehdr, Section_Table *secTab, symbolTable *symTabFull, Data_Rel *drel)
+void dump_relocation(Text_Buffer *out, Elf32_Ehdr *ehdr, Section_Table *secTab, symbolTable *symTabFull, Data_Rel *drel)
 {
-    dump_relocation_type(ehdr, secTab, symTabFull, drel, 0);
-    dump_relocation_type(ehdr, secTab, symTabFull, drel, 1);
+    dump_relocation_type(out, ehdr, secTab, symTabFull, drel, 0);
+    dump_relocation_type(out, ehdr, secTab, symTabFull, drel, 1);
 }
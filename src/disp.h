@@ -2,55 +2,62 @@
 #define _DISP_H_
 
 #include <elf.h>
+#include "text_buffer.h"
 // #include "elf_common.h"
 
 /**
  * Affiche les informations sur l'en-tête lu
  *
+ * @param out:  le tampon où écrire
  * @param ehdr: une structure de type Elf32_Ehdr initialisée
  **/
-void dump_header(Elf32_Ehdr *ehdr);
+void dump_header(Text_Buffer *out, Elf32_Ehdr *ehdr);
 
 /**
  * Affiche le contenu brut d'une section
  *
- * @param fd:   un descripteur de fichier (ELF32)
+ * @param out:  le tampon où écrire
+ * @param ef:   une structure de type Elf_File initialisée (ELF32)
  * @param secTab: une structure de type Section_Table initialisée
  * @param index: le numéro d'une section
  **/
-void dump_section (int fd, Section_Table *secTab, unsigned index);
+void dump_section (Text_Buffer *out, Elf_File *ef, Section_Table *secTab, unsigned index);
 
 /**
  * Affiche les informations sur l'en-tête de section lu
  *
+ * @param out:    le tampon où écrire
  * @param secTab: une structure de type Section_Table initialisée
  * @param offset: l'adresse de décalage (ehdr->e_shoff)
  **/
-void dump_section_header(Section_Table *secTab, Elf32_Off offset);
+void dump_section_header(Text_Buffer *out, Section_Table *secTab, Elf32_Off offset);
 
 
 /**
  * Affiche la table des symboles
  *
+ * @param out: le tampon où écrire
  * @param s: Une structure Symtab_Struct.
  **/
-void dump_symtab(Symtab_Struct *s);
+void dump_symtab(Text_Buffer *out, Symtab_Struct *s);
 
 /*
  * Affiche une table de symbole.
  *
+ * @param out: le tampon où écrire
  * @param symTabToDisp: un pointeur vers une structure symbolTable contenant les informations à afficher.
  */
-void displ_symbolTable(symbolTable *st);
+void displ_symbolTable(Text_Buffer *out, symbolTable *st);
 
 /**
  * Affiche les réimplantations
  *
+ * @param out:   le tampon où écrire
  * @param ehdr:  une structure de type Elf32_Ehdr initialisée
  * @param secTab: une structure de type Section_Table initialisée
  * @param symTabFull: une structure de type symbolTable
  * @param drel:  une structure de type Data_Rel initialisée
  **/
-void dump_relocation(Elf32_Ehdr *ehdr, Section_Table *secTab, symbolTable *symTabFull, Data_Rel *drel);
+void dump_relocation(Text_Buffer *out, Elf32_Ehdr *ehdr, Section_Table *secTab, symbolTable *symTabFull, Data_Rel *drel);
 
 #endif
@@ -10,42 +10,47 @@
 #include "elf_common.h"
 #include "util.h"
 
-Elf32_Ehdr *read_elf_header(int fd)
+Elf32_Ehdr *read_elf_header(Elf_File *ef)
 {
-	Elf32_Ehdr *ehdr = malloc(sizeof(Elf32_Ehdr));
+	Elf32_Ehdr *ehdr = arena_alloc(ef->arena, sizeof(Elf32_Ehdr));
+	const unsigned char *p = get_elf_view(ef, 0, sizeof(Elf32_Ehdr));
 
-	read(fd, ehdr->e_ident, EI_NIDENT);
-	if(ehdr->e_ident[0] != ELFMAG0 || ehdr->e_ident[1] != ELFMAG1 || ehdr->e_ident[2] != ELFMAG2 || ehdr->e_ident[3] != ELFMAG3 || ehdr->e_ident[EI_CLASS] != ELFCLASS32)
+	if(p == NULL || p[0] != ELFMAG0 || p[1] != ELFMAG1 || p[2] != ELFMAG2 || p[3] != ELFMAG3 || p[EI_CLASS] != ELFCLASS32)
 	{
-		fprintf(stderr, "Le fichier n'est pas de type ELF32.\n");
-		exit(3);
+		set_elf_error(ef, "Le fichier n'est pas de type ELF32.");
+		arena_free(ef->arena, ehdr);
+		return NULL;
 	}
+	memcpy(ehdr->e_ident, p, EI_NIDENT);
 
-	if(ehdr->e_ident[EI_DATA] == ELFDATA2LSB)
-		elf32_is_big = 0;
-	else if(ehdr->e_ident[EI_DATA] == ELFDATA2MSB)
-		elf32_is_big = 1;
+	/* Le boutisme est choisi une fois pour toutes, pour ce fichier uniquement */
+	if(init_elf_decoder(&ef->dec, ehdr->e_ident[EI_DATA]))
+	{
+		set_elf_error(ef, "Le boutisme du fichier est inconnu.");
+		arena_free(ef->arena, ehdr);
+		return NULL;
+	}
 
-	read(fd, &ehdr->e_type,      sizeof(ehdr->e_type));
-	read(fd, &ehdr->e_machine,   sizeof(ehdr->e_machine));
-	read(fd, &ehdr->e_version,   sizeof(ehdr->e_version));
-	read(fd, &ehdr->e_entry,     sizeof(ehdr->e_entry));
-	read(fd, &ehdr->e_phoff,     sizeof(ehdr->e_phoff));
-	read(fd, &ehdr->e_shoff,     sizeof(ehdr->e_shoff));
-	read(fd, &ehdr->e_flags,     sizeof(ehdr->e_flags));
-	read(fd, &ehdr->e_ehsize,    sizeof(ehdr->e_ehsize));
-	read(fd, &ehdr->e_phentsize, sizeof(ehdr->e_phentsize));
-	read(fd, &ehdr->e_phnum,     sizeof(ehdr->e_phnum));
-	read(fd, &ehdr->e_shentsize, sizeof(ehdr->e_shentsize));
-	read(fd, &ehdr->e_shnum,     sizeof(ehdr->e_shnum));
-	read(fd, &ehdr->e_shstrndx,  sizeof(ehdr->e_shstrndx));
+	ehdr->e_type      = ELF_FIELD(ef, p, Elf32_Ehdr, e_type);
+	ehdr->e_machine   = ELF_FIELD(ef, p, Elf32_Ehdr, e_machine);
+	ehdr->e_version   = ELF_FIELD(ef, p, Elf32_Ehdr, e_version);
+	ehdr->e_entry     = ELF_FIELD(ef, p, Elf32_Ehdr, e_entry);
+	ehdr->e_phoff     = ELF_FIELD(ef, p, Elf32_Ehdr, e_phoff);
+	ehdr->e_shoff     = ELF_FIELD(ef, p, Elf32_Ehdr, e_shoff);
+	ehdr->e_flags     = ELF_FIELD(ef, p, Elf32_Ehdr, e_flags);
+	ehdr->e_ehsize    = ELF_FIELD(ef, p, Elf32_Ehdr, e_ehsize);
+	ehdr->e_phentsize = ELF_FIELD(ef, p, Elf32_Ehdr, e_phentsize);
+	ehdr->e_phnum     = ELF_FIELD(ef, p, Elf32_Ehdr, e_phnum);
+	ehdr->e_shentsize = ELF_FIELD(ef, p, Elf32_Ehdr, e_shentsize);
+	ehdr->e_shnum     = ELF_FIELD(ef, p, Elf32_Ehdr, e_shnum);
+	ehdr->e_shstrndx  = ELF_FIELD(ef, p, Elf32_Ehdr, e_shstrndx);
 
 	return ehdr;
 }
 
-void destroy_elf_header(Elf32_Ehdr *ehdr)
+void destroy_elf_header(Elf_File *ef, Elf32_Ehdr *ehdr)
 {
-	free(ehdr);
+	arena_free(ef->arena, ehdr);
 }
 
 int get_section_index(Section_Table *secTab, int shType) {
@@ -60,14 +65,16 @@ int get_section_index(Section_Table *secTab, int shType) {
 	return idx;
 }
 
-char *get_name_table(int fd, int idxSection, Elf32_Shdr **shdr)
+char *get_name_table(Elf_File *ef, int idxSection, Elf32_Shdr **shdr, unsigned nb_sections)
 {
-	char *table = (char *) malloc(sizeof(char) * shdr[idxSection]->sh_size);
-
-	lseek(fd, shdr[idxSection]->sh_offset, SEEK_SET);
-	read(fd, table, shdr[idxSection]->sh_size);
+	if((idxSection < 0) || (idxSection >= nb_sections))
+	{
+		set_elf_error(ef, "La table de noms %i n'existe pas.", idxSection);
+		return NULL;
+	}
 
-	return table;
+	/* Les noms ne dépendent pas du boutisme : on les lit directement dans la projection */
+	return (char *) get_elf_view_or_error(ef, shdr[idxSection]->sh_offset, shdr[idxSection]->sh_size);
 }
 
 char *get_section_name(Section_Table *secTab, unsigned index)
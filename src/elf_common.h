@@ -2,22 +2,25 @@
 #define _ELF_COMMON_H_
 
 #include <elf.h>
+#include "elf_file.h"
 #include "section.h"
 
 /**
  * Lis l'en-tête d'un fichier ELF 32 bits et stocke les informations dans une structure
  *
- * @param fd:   un descripteur de fichier (ELF32)
- * @retourne un pointeur sur une structure de type Elf32_Ehdr
+ * @param ef:   une structure de type Elf_File initialisée (ELF32)
+ * @retourne un pointeur sur une structure de type Elf32_Ehdr, ou NULL si le fichier n'est pas
+ * un fichier ELF32 valide (l'erreur est dans ef->error)
  **/
-Elf32_Ehdr *read_elf_header(int fd);
+Elf32_Ehdr *read_elf_header(Elf_File *ef);
 
 /**
- * Libère la mémoire occupée par une structure Elf32_Ehdr
+ * Libère la mémoire occupée par une structure Elf32_Ehdr (rien si elle est dans une arène)
  *
+ * @param ef:   le fichier ELF dont l'en-tête a été lu
  * @param ehdr: une structure de type Elf32_Ehdr initialisée
  **/
-void destroy_elf_header(Elf32_Ehdr *ehdr);
+void destroy_elf_header(Elf_File *ef, Elf32_Ehdr *ehdr);
 
 /*
  * Retourne l'index d'une section selon son type.
@@ -30,14 +33,16 @@ void destroy_elf_header(Elf32_Ehdr *ehdr);
 int get_section_index(Section_Table *secTab, int shType);
 
 /**
- * Lis la table des noms de section d'un fichier ELF 32 bits et retourne la table
+ * Retourne une table de noms d'un fichier ELF 32 bits, sans copie
  *
- * @param fd:   un descripteur de fichier (ELF32)
+ * @param ef:   une structure de type Elf_File initialisée (ELF32)
  * @param idxSection: index de la section
  * @param shdr: un tableau de structures de type Elf32_Shdr initialisé
- * @retourne la table des noms de section
+ * @param nb_sections: le nombre de sections du tableau
+ * @retourne la table des noms, qui pointe dans la projection du fichier (à ne pas libérer),
+ * ou NULL si elle n'existe pas ou dépasse du fichier (l'erreur est dans ef->error)
  **/
-char *get_name_table(int fd, int idxSection, Elf32_Shdr **shdr);
+char *get_name_table(Elf_File *ef, int idxSection, Elf32_Shdr **shdr, unsigned nb_sections);
 
 /**
  * Retourne le nom d'une section donnée
@@ -0,0 +1,179 @@
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+#include "elf_decoder.h"
+#include "util.h"
+
+int init_elf_decoder(Elf_Decoder *dec, unsigned char ei_data)
+{
+	if((ei_data != ELFDATA2LSB) && (ei_data != ELFDATA2MSB))
+		return -1;
+
+	dec->is_big = (ei_data == ELFDATA2MSB);
+	dec->swap   = (dec->is_big != is_big_endian());
+	return 0;
+}
+
+uint32_t decode_elf_value(const Elf_Decoder *dec, const unsigned char *p, size_t size)
+{
+	uint16_t v2;
+	uint32_t v4;
+
+	switch(size)
+	{
+		case sizeof(uint8_t):
+			return *p;
+		case sizeof(uint16_t):
+			memcpy(&v2, p, sizeof(v2));
+			return dec->swap ? (uint16_t) reverse_2(v2) : v2;
+		default:
+			memcpy(&v4, p, sizeof(v4));
+			return dec->swap ? (uint32_t) reverse_4(v4) : v4;
+	}
+}
+
+/* Masques pour pshufb : chaque octet de destination prend l'octet source d'indice donné.
+ * Les en-têtes de section et les réimplantations ne contiennent que des mots de 4 octets ;
+ * un symbole occupe exactement 16 octets (trois mots, deux octets et un demi-mot) */
+static const unsigned char words_mask[16]  = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+static const unsigned char symbol_mask[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 12, 13, 15, 14 };
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+
+__attribute__((target("avx2")))
+static size_t shuffle_avx2(unsigned char *p, size_t size, const unsigned char *mask)
+{
+	size_t i;
+	__m256i m = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) mask));
+
+	for(i = 0; i + 32 <= size; i += 32)
+		_mm256_storeu_si256((__m256i *) (p + i), _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *) (p + i)), m));
+	return i;
+}
+
+__attribute__((target("ssse3")))
+static size_t shuffle_ssse3(unsigned char *p, size_t size, const unsigned char *mask)
+{
+	size_t i;
+	__m128i m = _mm_loadu_si128((const __m128i *) mask);
+
+	for(i = 0; i + 16 <= size; i += 16)
+		_mm_storeu_si128((__m128i *) (p + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (p + i)), m));
+	return i;
+}
+
+/* Applique le masque à chaque bloc de 16 octets et retourne le nombre d'octets traités ;
+ * le jeu d'instructions est choisi à l'exécution */
+static size_t shuffle_blocks(unsigned char *p, size_t size, const unsigned char *mask)
+{
+	if(__builtin_cpu_supports("avx2"))
+	{
+		size_t done = shuffle_avx2(p, size, mask);
+		return done + shuffle_ssse3(p + done, size - done, mask);
+	}
+	if(__builtin_cpu_supports("ssse3"))
+		return shuffle_ssse3(p, size, mask);
+	return 0;
+}
+#else
+static size_t shuffle_blocks(unsigned char *p, size_t size, const unsigned char *mask)
+{
+	(void) p; (void) size; (void) mask;
+	return 0;
+}
+#endif
+
+static void swap_words(uint32_t *w, size_t n)
+{
+	size_t done = shuffle_blocks((unsigned char *) w, n * sizeof(uint32_t), words_mask) / sizeof(uint32_t);
+
+	for(size_t i = done; i < n; i++)
+		w[i] = reverse_4(w[i]);
+}
+
+void swap_elf32_shdr_array(Elf32_Shdr *tab, unsigned n)
+{
+	swap_words((uint32_t *) tab, (size_t) n * sizeof(Elf32_Shdr) / sizeof(uint32_t));
+}
+
+void swap_elf32_rel_array(Elf32_Rel *tab, unsigned n)
+{
+	swap_words((uint32_t *) tab, (size_t) n * sizeof(Elf32_Rel) / sizeof(uint32_t));
+}
+
+void swap_elf32_rela_array(Elf32_Rela *tab, unsigned n)
+{
+	swap_words((uint32_t *) tab, (size_t) n * sizeof(Elf32_Rela) / sizeof(uint32_t));
+}
+
+void swap_elf32_sym_array(Elf32_Sym *tab, unsigned n)
+{
+	unsigned i = shuffle_blocks((unsigned char *) tab, (size_t) n * sizeof(Elf32_Sym), symbol_mask) / sizeof(Elf32_Sym);
+
+	for(; i < n; i++)
+	{
+		tab[i].st_name  = reverse_4(tab[i].st_name);
+		tab[i].st_value = reverse_4(tab[i].st_value);
+		tab[i].st_size  = reverse_4(tab[i].st_size);
+		tab[i].st_shndx = reverse_2(tab[i].st_shndx);
+	}
+}
+
+void swap_elf32_ehdr(Elf32_Ehdr *ehdr)
+{
+	ehdr->e_type      = reverse_2(ehdr->e_type);
+	ehdr->e_machine   = reverse_2(ehdr->e_machine);
+	ehdr->e_version   = reverse_4(ehdr->e_version);
+	ehdr->e_entry     = reverse_4(ehdr->e_entry);
+	ehdr->e_phoff     = reverse_4(ehdr->e_phoff);
+	ehdr->e_shoff     = reverse_4(ehdr->e_shoff);
+	ehdr->e_flags     = reverse_4(ehdr->e_flags);
+	ehdr->e_ehsize    = reverse_2(ehdr->e_ehsize);
+	ehdr->e_phentsize = reverse_2(ehdr->e_phentsize);
+	ehdr->e_phnum     = reverse_2(ehdr->e_phnum);
+	ehdr->e_shentsize = reverse_2(ehdr->e_shentsize);
+	ehdr->e_shnum     = reverse_2(ehdr->e_shnum);
+	ehdr->e_shstrndx  = reverse_2(ehdr->e_shstrndx);
+}
+
+/* Recopie n structures de taille size, espacées de stride octets dans la source */
+static void copy_array(void *dst, const unsigned char *src, unsigned n, size_t size, size_t stride)
+{
+	if(stride == size)
+	{
+		memcpy(dst, src, (size_t) n * size);
+		return;
+	}
+	for(unsigned i = 0; i < n; i++)
+		memcpy((unsigned char *) dst + i * size, src + i * stride, size);
+}
+
+void decode_elf32_shdr_array(const Elf_Decoder *dec, Elf32_Shdr *dst, const unsigned char *src, unsigned n, size_t stride)
+{
+	copy_array(dst, src, n, sizeof(Elf32_Shdr), stride);
+	if(dec->swap)
+		swap_elf32_shdr_array(dst, n);
+}
+
+void decode_elf32_sym_array(const Elf_Decoder *dec, Elf32_Sym *dst, const unsigned char *src, unsigned n, size_t stride)
+{
+	copy_array(dst, src, n, sizeof(Elf32_Sym), stride);
+	if(dec->swap)
+		swap_elf32_sym_array(dst, n);
+}
+
+void decode_elf32_rel_array(const Elf_Decoder *dec, Elf32_Rel *dst, const unsigned char *src, unsigned n, size_t stride)
+{
+	copy_array(dst, src, n, sizeof(Elf32_Rel), stride);
+	if(dec->swap)
+		swap_elf32_rel_array(dst, n);
+}
+
+void decode_elf32_rela_array(const Elf_Decoder *dec, Elf32_Rela *dst, const unsigned char *src, unsigned n, size_t stride)
+{
+	copy_array(dst, src, n, sizeof(Elf32_Rela), stride);
+	if(dec->swap)
+		swap_elf32_rela_array(dst, n);
+}
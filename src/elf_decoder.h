@@ -0,0 +1,81 @@
+#ifndef _ELF_DECODER_H_
+#define _ELF_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <elf.h>
+
+typedef struct
+{
+	int is_big; // Vaut 1 si le fichier est au format big endian
+	int swap;   // Vaut 1 si les données doivent être inversées pour l'hôte
+} Elf_Decoder;
+
+/**
+ * Lis la valeur d'un champ d'une structure ELF stockée dans l'ordre des octets d'un fichier
+ *
+ * @param dec:   une structure de type Elf_Decoder initialisée
+ * @param p:     un pointeur sur le début de la structure
+ * @param type:  le type de la structure (Elf32_Ehdr, Elf32_Shdr, ...)
+ * @param field: le nom du champ à lire
+ * @retourne la valeur du champ, dans l'ordre des octets de l'hôte
+ **/
+#define DECODE_FIELD(dec, p, type, field) \
+	decode_elf_value((dec), (p) + offsetof(type, field), sizeof(((type *) 0)->field))
+
+/**
+ * Initialise un décodeur à partir de l'octet EI_DATA de l'identification d'un fichier
+ *
+ * @param dec:     une structure de type Elf_Decoder
+ * @param ei_data: l'octet e_ident[EI_DATA] du fichier
+ * @retourne 0 en cas de succès, -1 si le boutisme est inconnu
+ **/
+int init_elf_decoder(Elf_Decoder *dec, unsigned char ei_data);
+
+/**
+ * Lis une valeur de 1, 2 ou 4 octets en tenant compte du boutisme du fichier
+ *
+ * @param dec:  une structure de type Elf_Decoder initialisée
+ * @param p:    un pointeur sur la valeur
+ * @param size: la taille de la valeur (1, 2 ou 4)
+ * @retourne la valeur lue, dans l'ordre des octets de l'hôte
+ **/
+uint32_t decode_elf_value(const Elf_Decoder *dec, const unsigned char *p, size_t size);
+
+/**
+ * Inversent l'ordre des octets de chaque champ d'un tableau de structures ELF, sur place.
+ * L'opération est son propre inverse : elle sert aussi bien à décoder qu'à réencoder.
+ * Les blocs de 16 octets sont traités avec pshufb (AVX2 ou SSSE3) si le processeur le permet
+ *
+ * @param tab: un tableau contigu de structures
+ * @param n:   le nombre de structures du tableau
+ **/
+void swap_elf32_shdr_array(Elf32_Shdr *tab, unsigned n);
+void swap_elf32_sym_array(Elf32_Sym *tab, unsigned n);
+void swap_elf32_rel_array(Elf32_Rel *tab, unsigned n);
+void swap_elf32_rela_array(Elf32_Rela *tab, unsigned n);
+
+/**
+ * Inverse l'ordre des octets de chaque champ d'un en-tête ELF, sur place (e_ident n'est pas modifié)
+ *
+ * @param ehdr: une structure de type Elf32_Ehdr
+ **/
+void swap_elf32_ehdr(Elf32_Ehdr *ehdr);
+
+/**
+ * Recopient un tableau de structures ELF stocké dans l'ordre des octets d'un fichier
+ * (par exemple dans sa projection en mémoire) vers un tableau contigu, dans l'ordre de l'hôte
+ *
+ * @param dec:    une structure de type Elf_Decoder initialisée
+ * @param dst:    le tableau de destination, de n structures
+ * @param src:    le début du tableau source
+ * @param n:      le nombre de structures à recopier
+ * @param stride: l'écart en octets entre deux structures du tableau source (sh_entsize)
+ **/
+void decode_elf32_shdr_array(const Elf_Decoder *dec, Elf32_Shdr *dst, const unsigned char *src, unsigned n, size_t stride);
+void decode_elf32_sym_array(const Elf_Decoder *dec, Elf32_Sym *dst, const unsigned char *src, unsigned n, size_t stride);
+void decode_elf32_rel_array(const Elf_Decoder *dec, Elf32_Rel *dst, const unsigned char *src, unsigned n, size_t stride);
+void decode_elf32_rela_array(const Elf_Decoder *dec, Elf32_Rela *dst, const unsigned char *src, unsigned n, size_t stride);
+
+
+#endif
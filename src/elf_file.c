@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <elf.h>
+
+#include "elf_file.h"
+#include "util.h"
+
+Elf_File *open_elf_file(const char *filename)
+{
+	struct stat st;
+	Elf_File *ef;
+	int fd = open(filename, O_RDONLY);
+
+	if(fd < 0)
+		return NULL;
+	if((fstat(fd, &st) < 0) || (st.st_size < EI_NIDENT))
+	{
+		close(fd);
+		return NULL;
+	}
+
+	ef = malloc(sizeof(Elf_File));
+	ef->fd    = fd;
+	ef->size  = st.st_size;
+	ef->arena = NULL;
+	ef->error[0] = '\0';
+	ef->nb_syscalls  = 3;
+	ef->bytes_viewed = 0;
+	ef->map  = mmap(NULL, ef->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(ef->map == MAP_FAILED)
+	{
+		close(fd);
+		free(ef);
+		return NULL;
+	}
+
+	/* Le boutisme est choisi par read_elf_header ; d'ici là, on lit dans l'ordre de l'hôte */
+	ef->dec.is_big = is_big_endian();
+	ef->dec.swap   = 0;
+
+	return ef;
+}
+
+void close_elf_file(Elf_File *ef)
+{
+	munmap(ef->map, ef->size);
+	close(ef->fd);
+	free(ef);
+}
+
+int is_in_elf_file(const Elf_File *ef, Elf32_Off offset, Elf32_Word size)
+{
+	return (offset <= ef->size) && (size <= ef->size - offset);
+}
+
+const unsigned char *get_elf_view(Elf_File *ef, Elf32_Off offset, Elf32_Word size)
+{
+	if(!is_in_elf_file(ef, offset, size))
+		return NULL;
+	ef->bytes_viewed += size;
+	return ef->map + offset;
+}
+
+void set_elf_error(Elf_File *ef, const char *format, ...)
+{
+	va_list aptr;
+
+	if(ef->error[0] != '\0')
+		return;
+	va_start(aptr, format);
+	vsnprintf(ef->error, sizeof(ef->error), format, aptr);
+	va_end(aptr);
+}
+
+const unsigned char *get_elf_view_or_error(Elf_File *ef, Elf32_Off offset, Elf32_Word size)
+{
+	const unsigned char *p = get_elf_view(ef, offset, size);
+
+	if(p == NULL)
+		set_elf_error(ef, "Le fichier est tronqué : %u octets à l'adresse de décalage %#x dépassent de la fin du fichier.", size, offset);
+	return p;
+}
+
+const unsigned char *get_elf_view_or_die(Elf_File *ef, Elf32_Off offset, Elf32_Word size)
+{
+	const unsigned char *p = get_elf_view_or_error(ef, offset, size);
+
+	if(p == NULL)
+	{
+		fprintf(stderr, "%s\n", ef->error);
+		exit(3);
+	}
+	return p;
+}
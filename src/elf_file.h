@@ -0,0 +1,100 @@
+#ifndef _ELF_FILE_H_
+#define _ELF_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <elf.h>
+#include "elf_decoder.h"
+#include "arena.h"
+
+typedef struct
+{
+	int fd;             // Descripteur du fichier (ouvert en lecture)
+	unsigned char *map; // Projection en mémoire de tout le fichier
+	size_t size;        // Taille de la projection
+	Elf_Decoder dec;    // Boutisme du fichier, choisi à la lecture de l'en-tête ELF
+	Arena *arena;       // Arène où sont allouées les structures lues (NULL : malloc, libérées par les destroy_*)
+	char error[256];    // Première erreur rencontrée à la lecture (vide s'il n'y en a pas)
+	unsigned nb_syscalls; // Appels système faits par open_elf_file (open, fstat, mmap)
+	size_t bytes_viewed;  // Octets de la projection rendus par get_elf_view (une zone relue compte à chaque fois)
+} Elf_File;
+
+/**
+ * Lis la valeur d'un champ d'une structure ELF projetée en mémoire
+ *
+ * @param ef:    une structure de type Elf_File initialisée
+ * @param p:     un pointeur sur le début de la structure dans la projection
+ * @param type:  le type de la structure (Elf32_Ehdr, Elf32_Shdr, ...)
+ * @param field: le nom du champ à lire
+ * @retourne la valeur du champ, dans l'ordre des octets de l'hôte
+ **/
+#define ELF_FIELD(ef, p, type, field) DECODE_FIELD(&(ef)->dec, p, type, field)
+
+/**
+ * Ouvre un fichier ELF en lecture et le projette entièrement en mémoire
+ *
+ * @param filename: le chemin du fichier
+ * @retourne un pointeur sur une structure de type Elf_File, ou NULL en cas d'échec
+ **/
+Elf_File *open_elf_file(const char *filename);
+
+/**
+ * Supprime la projection d'un fichier ELF et le ferme
+ *
+ * @param ef: une structure de type Elf_File initialisée
+ **/
+void close_elf_file(Elf_File *ef);
+
+/**
+ * Vérifie qu'une zone est entièrement dans le fichier, sans la lire
+ *
+ * @param ef:     une structure de type Elf_File initialisée
+ * @param offset: l'adresse de décalage de la zone dans le fichier
+ * @param size:   la taille de la zone
+ * @retourne 1 si la zone est dans le fichier, 0 sinon
+ **/
+int is_in_elf_file(const Elf_File *ef, Elf32_Off offset, Elf32_Word size);
+
+/**
+ * Retourne un pointeur sur une zone de la projection, après vérification des bornes ;
+ * la taille de la zone est ajoutée à ef->bytes_viewed
+ *
+ * @param ef:     une structure de type Elf_File initialisée
+ * @param offset: l'adresse de décalage de la zone dans le fichier
+ * @param size:   la taille de la zone
+ * @retourne un pointeur dans la projection, ou NULL si la zone dépasse du fichier
+ **/
+const unsigned char *get_elf_view(Elf_File *ef, Elf32_Off offset, Elf32_Word size);
+
+/**
+ * Retient une erreur de lecture du fichier, si aucune ne l'a été avant ; les fonctions de lecture
+ * retournent alors NULL et l'appelant affiche ef->error
+ *
+ * @param ef:     une structure de type Elf_File initialisée
+ * @param format: le message, formaté comme avec printf (sans retour à la ligne final)
+ **/
+void set_elf_error(Elf_File *ef, const char *format, ...);
+
+/**
+ * Retourne un pointeur sur une zone de la projection ; si elle dépasse du fichier,
+ * l'erreur est retenue dans ef->error
+ *
+ * @param ef:     une structure de type Elf_File initialisée
+ * @param offset: l'adresse de décalage de la zone dans le fichier
+ * @param size:   la taille de la zone
+ * @retourne un pointeur dans la projection, ou NULL si la zone dépasse du fichier
+ **/
+const unsigned char *get_elf_view_or_error(Elf_File *ef, Elf32_Off offset, Elf32_Word size);
+
+/**
+ * Retourne un pointeur sur une zone de la projection, et quitte si elle dépasse du fichier
+ *
+ * @param ef:     une structure de type Elf_File initialisée
+ * @param offset: l'adresse de décalage de la zone dans le fichier
+ * @param size:   la taille de la zone
+ * @retourne un pointeur dans la projection
+ **/
+const unsigned char *get_elf_view_or_die(Elf_File *ef, Elf32_Off offset, Elf32_Word size);
+
+
+#endif
@@ -1,678 +1,1073 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <stdarg.h>
 #include <string.h>
 #include <unistd.h>
 #include <elf.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include "elf_file.h"
 #include "elf_common.h"
 #include "util.h"
 #include "section.h"
 #include "symbol.h"
 #include "relocation.h"
+#include "name_index.h"
+#include "thread_pool.h"
+#include "out_image.h"
+#include "arena.h"
 #include "disp.h"
+#include "stats.h"
+#include "trace.h"
 
 #include "fusion.h"
 
+/* Taille des blocs des arènes (celle de la fusion et celle de chaque fichier d'entrée) */
+#define ARENA_BLOCK (64 * 1024)
+
+/* Au-delà de ce nombre de valeurs corrigées, une partie de section est recopiée en mémoire
+ * plutôt que d'être recopiée de fichier à fichier puis corrigée valeur par valeur */
+#define MAX_PART_PATCHES 64
 
 int main(int argc, char *argv[])
 {
 	int err = 0;
+	unsigned nb_symbols = 0, nb_sections = 0;
+	int stats_format = parse_stats_option(&argc, argv);
 
-	if(argc < 4)
+	if((argc < 3) || (stats_format < 0))
 	{
-		fprintf(stderr, "%s : FICHIER_ENTRÉE1 FICHIER_ENTRÉE2 FICHIER_SORTIE\n", argv[0]);
+		fprintf(stderr, "%s [--stats[=json]] FICHIER_SORTIE FICHIER_ENTRÉE1 [FICHIER_ENTRÉE2 ...]\n", argv[0]);
 		return 1;
 	}
-
-	/* Ouverture des fichiers passés en argument */
-	int fd_in1, fd_in2, fd_out;
-	if(open_files(argv, &fd_in1, &fd_in2, &fd_out))
-		return 2;
-
-	/* Initialisation des structures */
-	Elf32_Ehdr *ehdr1      = read_elf_header(fd_in1);
-	Elf32_Ehdr *ehdr2      = read_elf_header(fd_in2);
-	Section_Table *secTab1 = read_sectionTable(fd_in1, ehdr1);
-	Section_Table *secTab2 = read_sectionTable(fd_in2, ehdr2);
-	symbolTable *st1       = read_symbolTable(fd_in1, secTab1);
-	symbolTable *st2       = read_symbolTable(fd_in2, secTab2);
-	Symtab_Struct *st_out  = read_symtab_struct(fd_in1, secTab1, SHT_SYMTAB); // En réalité, on duplique la table des symboles du premier fichier
-	Data_Rel *drel1        = read_relocationTables(fd_in1, secTab1);
-	Data_Rel *drel2        = read_relocationTables(fd_in2, secTab2);
-	Data_fusion *df        = malloc(sizeof(Data_fusion));
-	df->f = NULL;
-	df->offset = 0;
+	init_trace();
+
+	/* Ouverture des fichiers passés en argument ; tout ce qui dure jusqu'à la fin est pris dans des arènes */
+	Arena *arena = create_arena(ARENA_BLOCK);
+	Data_fusion *df = arena_alloc(arena, sizeof(Data_fusion));
+	int fd_out;
+	df->arena       = arena;
+	df->f           = NULL;
+	df->offset      = 0;
 	df->nb_sections = 0;
-	df->nb_written  = 1;
-
-	/* On crée la nouvelle section n°0 de type NULL */
-	gather_sections(df, secTab1, secTab2, SKIP, ONLY1, 1, SHT_NULL);
-
-	/* On crée le fichier de sortie qui contient les sections PROGBITS fusionnées */
-	print_debug(BOLD "==> Étape de fusion des sections PROGBITS\n" RESET);
-	gather_sections(df, secTab1, secTab2, PROGBITS, MERGE, 2, SHT_PROGBITS, SHT_NOBITS);
+	df->nb_inputs   = argc - 2;
+	df->in          = arena_calloc(arena, df->nb_inputs, sizeof(Input_File));
+	df->strtab      = NULL;
+	df->section_index = NULL;
+	df->sorted_index  = NULL;
+	df->first_global  = 0;
+	df->nb_syscalls   = 0;
+	init_stats(&df->stats, stats_format);
+	if(open_files(argc, argv, df, &fd_out))
+	{
+		destroy_data_fusion(df);
+		return 2;
+	}
 
-	/* On recherche les sections de type REL */
-	print_debug(BOLD "\n==> Étape de récupération des sections REL(A)\n" RESET);
-	gather_sections(df, secTab1, secTab2, REL, MERGE, 2, SHT_REL, SHT_RELA);
+	/* Initialisation des structures : les fichiers d'entrée sont indépendants, on les lit en parallèle */
+	Thread_Pool *tp = create_thread_pool(min(df->nb_inputs, get_nb_cores()));
+	for(int k = 0; k < df->nb_inputs; k++)
+		submit_task(tp, load_input_file, &df->in[k]);
+	destroy_thread_pool(tp);
+	Symtab_Struct *st_out = NULL;
+	Out_Image *img = NULL;
+	if((err = check_input_files(df)))
+		goto clean;
+	df->dec = df->in[0].ef->dec;
+	st_out = read_symtab_struct(df->in[0].ef, df->in[0].secTab, SHT_SYMTAB); // En réalité, on duplique la table des symboles du premier fichier (dans son arène)
+	if(st_out->nbSymbol == 0)
+		append_symbol(st_out, &(Elf32_Sym) { 0 }); // Le premier fichier n'a pas de table des symboles : le symbole nul reste l'indice 0
+	for(int k = 0; k < df->nb_inputs; k++)
+	{
+		nb_symbols  += df->in[k].st->symtab->nbSymbol;
+		nb_sections += df->in[k].secTab->nb_sections;
+	}
+	end_phase(df, NULL, "lecture", "sections", nb_sections);
+	df->strtab = create_str_table(nb_symbols);
+	df->section_index = create_name_index(nb_sections);
 
-	/* On recherche les sections spécifiques à ARM */
-	print_debug(BOLD "\n==> Étape de récupération des sections ARM\n" RESET);
-	df->nb_written = df->nb_sections;
-	gather_sections(df, secTab1, secTab2, ARM, ONLY1, 3, SHT_ARM_EXIDX, SHT_ARM_PREEMPTMAP, SHT_ARM_ATTRIBUTES);
+	/* On rassemble les sections par genre : NULL, PROGBITS, REL(A), ARM, puis toutes les autres */
+	gather_sections(df);
 
-	/* En enfin, on recherche toutes les autres sections */
-	print_debug(BOLD "\n==> Étape de récupération des autres sections\n" RESET);
-	gather_sections(df, secTab1, secTab2, SKIP, MERGE_NOT_IN, 8, SHT_NULL, SHT_PROGBITS, SHT_NOBITS,
-		SHT_REL, SHT_RELA, SHT_ARM_EXIDX, SHT_ARM_PREEMPTMAP, SHT_ARM_ATTRIBUTES);
+	/* On place les sections dans le fichier de sortie */
+	TRACE(TRACE_SECTIONS, TRACE_STEPS, BOLD "\n==> Étape de placement des sections\n" RESET);
+	layout_sections(df);
+	end_phase(df, NULL, "rassemblement", "sections", df->nb_sections);
 
 	/* On calcule les nouveaux indices de section */
-	print_debug(BOLD "\n==> Étape de création des tables de correspondance\n" RESET);
-	find_new_section_index(df, secTab1, secTab2);
+	TRACE(TRACE_SECTIONS, TRACE_STEPS, BOLD "\n==> Étape de création des tables de correspondance\n" RESET);
+	find_new_section_index(df);
 
 	/* On met à jour l'indice de section des sections */
-	print_debug(BOLD "\n==> Étape de mise à jour des indices de section des sections\n" RESET);
+	TRACE(TRACE_SECTIONS, TRACE_STEPS, BOLD "\n==> Étape de mise à jour des indices de section des sections\n" RESET);
 	update_section_index_in_sections(df);
 
 	/* On met à jour l'indice de section des symboles du premier fichier */
-	print_debug(BOLD "\n==> Étape de mise à jour des indices de section des symboles\n" RESET);
+	TRACE(TRACE_SYMBOLS, TRACE_STEPS, BOLD "\n==> Étape de mise à jour des indices de section des symboles\n" RESET);
 	for(int i = 1; i < st_out->nbSymbol; i++)
-		update_section_index_in_symbol(st_out->tab[i], df->newsec1, df->nb_sections);
+		update_section_index_in_symbol(&st_out->tab[i], &df->in[0]);
+	end_phase(df, NULL, "renumérotation", "sections", nb_sections);
 
 	/* On fusionne et corrige les symboles */
-	print_debug(BOLD "\n==> Étape de fusion des tables de symboles\n" RESET);
-	if((err = merge_and_fix_symbols(df, secTab1, secTab2, st1, st2, st_out)))
+	TRACE(TRACE_SYMBOLS, TRACE_STEPS, BOLD "\n==> Étape de fusion des tables de symboles\n" RESET);
+	if((err = merge_and_fix_symbols(df, st_out)))
+		goto clean;
+	end_phase(df, NULL, "symboles", "symboles", nb_symbols);
+	sort_new_symbol_table(df, st_out);
+	end_phase(df, NULL, "tri", "symboles", st_out->nbSymbol);
+	if(trace_enabled(TRACE_SYMBOLS, TRACE_DETAIL))
+	{
+		trace_printf(BOLD "\n==> Affichage de la fusion des symboles\n" RESET);
+		dump_symtab(get_trace_sink(), st_out);
+		release_trace_sink();
+	}
+
+	/* On fusionne les tables de réimplantations, ce qui corrige une copie du contenu des sections */
+	img = create_out_image(2 * df->nb_sections + 2);
+	TRACE(TRACE_RELOCS, TRACE_STEPS, BOLD "\n==> Étape de fusion des tables de réimplantations\n" RESET);
+	merge_and_fix_relocations(df, img);
+	end_phase(df, img, "réimplantations", "réimplantations", count_relocations(df));
+
+	/* On place le contenu des sections dans l'image du fichier */
+	TRACE(TRACE_IO, TRACE_STEPS, BOLD "\n==> Étape d'écriture des sections\n" RESET);
+	write_given_sections_in_file(df, img, PROGBITS);
+	write_given_sections_in_file(df, img, ARM);
+
+	/* On ajoute les tables et le nouvel en-tête, puis on écrit tout le fichier d'un coup */
+	TRACE(TRACE_IO, TRACE_STEPS, BOLD "\n==> Étape d'écriture du nouvel en-tête ELF\n" RESET);
+	if((err = write_new_symbol_table_in_file(img, df, st_out)))
 		goto clean;
-	sort_new_symbol_table(st_out);
-	if(print_debug(BOLD "\n==> Affichage de la fusion des symboles\n" RESET))
-		dump_symtab(st_out);
-
-	/* On met à jour le champ r_info des symboles des tables de réimplantations */
-	print_debug(BOLD "\n==> Étape de fusion des tables de réimplantations\n" RESET);
-	update_relocations_info(df, drel1, drel2, st1, st2);
-	merge_and_fix_relocations(df, fd_in2, fd_out, secTab1, secTab2, drel1, drel2);
-
-	/* On écrit enfin le nouveau fichier */
-	print_debug(BOLD "\n==> Étape d'écriture du nouvel en-tête ELF\n" RESET);
-	write_given_sections_in_file(df, fd_in1, fd_in2, fd_out, PROGBITS);
-	write_given_sections_in_file(df, fd_in1, fd_in2, fd_out, ARM);
-	write_new_symbol_table_in_file(fd_out, df, st_out);
-	write_new_section_table_in_file(fd_out, ehdr1, df);
-	write_elf_header_in_file(fd_out, ehdr1, df);
+	write_new_section_table_in_file(img, df->in[0].ehdr, df);
+	write_elf_header_in_file(img, df->in[0].ehdr, df);
+	if(write_out_image(fd_out, img) < 0)
+	{
+		fprintf(stderr, "FATAL : impossible d'écrire le fichier « %s » !\n", argv[1]);
+		err = 4;
+	}
+	end_phase(df, img, "écriture", "segments", img->nb_segments);
+	if(stats_enabled(&df->stats))
+	{
+		Text_Buffer out;
+		init_text_buffer(&out, STDOUT_FILENO);
+		print_stats(&df->stats, &out);
+		destroy_text_buffer(&out);
+	}
 
 clean:
-	close(fd_in1);
-	close(fd_in2);
 	close(fd_out);
-	destroy_elf_header(ehdr1);
-	destroy_elf_header(ehdr2);
-	destroy_sectionTable(secTab1);
-	destroy_sectionTable(secTab2);
-	destroy_symbolTable(st1);
-	destroy_symbolTable(st2);
-	destroy_symtab_struct(st_out);
-	destroy_relocationTables(drel1);
-	destroy_relocationTables(drel2);
+	if(img != NULL)
+		destroy_out_image(img);
 	destroy_data_fusion(df);
 
 	if(err)
-		remove(argv[3]);
+		remove(argv[1]);
 
 	return err;
 }
 
-#define CHECK_OPEN(f, i) if((f) < 0) { fprintf(stderr, "%s : Impossible d'ouvrir le fichier '%s'.\n", argv[0], argv[i]); return 1; }
-static int open_files(char *argv[], int *fd_in1, int *fd_in2, int *fd_out)
+#define CHECK_OPEN(ok, i) if(!(ok)) { fprintf(stderr, "%s : Impossible d'ouvrir le fichier '%s'.\n", argv[0], argv[i]); return 1; }
+static int open_files(int argc, char *argv[], Data_fusion *df, int *fd_out)
 {
-	*fd_in1 = open(argv[1], O_RDONLY);
-	CHECK_OPEN(*fd_in1, 1);
-	*fd_in2 = open(argv[2], O_RDONLY);
-	CHECK_OPEN(*fd_in2, 2);
-	*fd_out = open(argv[3], O_WRONLY | O_CREAT | O_TRUNC, 0644);
-	CHECK_OPEN(*fd_out, 3);
+	for(int i = 2; i < argc; i++)
+	{
+		df->in[i - 2].filename = argv[i];
+		df->in[i - 2].ef       = open_elf_file(argv[i]);
+		CHECK_OPEN(df->in[i - 2].ef != NULL, i);
+		df->in[i - 2].ef->arena = create_arena(ARENA_BLOCK);
+	}
+	*fd_out = open(argv[1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	df->nb_syscalls++;
+	CHECK_OPEN(*fd_out >= 0, 1);
 	return 0;
 }
 
-static void gather_sections(Data_fusion *df, Section_Table *secTab1, Section_Table *secTab2, Sections_Type type, Gather_Mode mode, int nb_types, ...)
+static void load_input_file(void *arg)
 {
-	int ind, j;
-	Elf32_Word *types = malloc(sizeof(Elf32_Word) * nb_types);
-	df->range[type].start = 0;
+	Input_File *in = arg;
+
+	/* À la première table illisible, les suivantes restent à NULL ; check_input_files affiche l'erreur */
+	in->ehdr   = read_elf_header(in->ef);
+	in->secTab = (in->ehdr   != NULL) ? read_sectionTable(in->ef, in->ehdr)       : NULL;
+	in->st     = (in->secTab != NULL) ? read_symbolTable(in->ef, in->secTab)      : NULL;
+	in->drel   = (in->st     != NULL) ? read_relocationTables(in->ef, in->secTab) : NULL;
+	in->newsec = NULL;
+	in->newsym = NULL;
+	in->shift  = (in->secTab != NULL) ? arena_calloc(in->ef->arena, in->secTab->nb_sections, sizeof(Elf32_Word)) : NULL;
+}
 
-	/* Récupération des types recherchés */
-	va_list aptr;
-	va_start(aptr, nb_types);
-	for(int i = 0; i < nb_types; i++)
-		types[i] = va_arg(aptr, Elf32_Word);
-	va_end(aptr);
+static int parse_stats_option(int *argc, char *argv[])
+{
+	int format = STATS_OFF;
+	int n = 1;
 
-	/* On parcours les sections PROGBITS du premier fichier */
-	for(int i = 0; i < secTab1->nb_sections; i++)
+	/* L'option est retirée des arguments, qui restent positionnels */
+	for(int i = 1; i < *argc; i++)
 	{
-		for(j = 0; (j < nb_types) && (secTab1->shdr[i]->sh_type) != types[j]; j++);
-		if(((mode == MERGE_NOT_IN) && (j != nb_types)) || ((mode != MERGE_NOT_IN) && (j == nb_types)))
-			continue;
+		if(!strcmp(argv[i], "--stats") || !strcmp(argv[i], "--stats=table"))
+			format = STATS_TABLE;
+		else if(!strcmp(argv[i], "--stats=json"))
+			format = STATS_JSON;
+		else if(!strncmp(argv[i], "--stats", 7))
+			format = -1;
+		else
+			argv[n++] = argv[i];
+	}
+	*argc = n;
+	argv[n] = NULL;
 
-		/* Recherche si la section est présente dans le second fichier */
-		for(j = 0; (j < secTab2->nb_sections) && strcmp(get_section_name(secTab1, i), get_section_name(secTab2, j)); j++);
+	return format;
+}
 
-		if(df->offset == 0)
-			df->offset = secTab1->shdr[i]->sh_offset;
+static void end_phase(Data_fusion *df, Out_Image *img, const char *name, const char *unit, unsigned long items)
+{
+	Stats_Counters now = { 0, 0, 0, 0, 0 };
+	size_t peak = df->arena->peak;
+	Arena *a;
 
-		ind = df->nb_sections;
-		df->nb_sections++;
-		df->f = realloc(df->f, sizeof(Fusion*) * df->nb_sections);
-		df->f[ind] = malloc(sizeof(Fusion));
-		df->f[ind]->offset = df->offset;
-		df->f[ind]->ptr_shdr1 = secTab1->shdr[i];
-		df->f[ind]->shdr = malloc(sizeof(Elf32_Shdr));
-		memcpy(df->f[ind]->shdr, secTab1->shdr[i], sizeof(Elf32_Shdr));
+	if(!stats_enabled(&df->stats))
+		return;
 
-		if(df->range[type].start == 0)
-			df->range[type].start = ind;
+	/* Les compteurs d'entrée-sortie sont tenus là où les appels sont faits : ouverture de la sortie,
+	 * open_elf_file, get_elf_view (octets de la projection effectivement demandés) et write_out_image */
+	now.syscalls    = df->nb_syscalls;
+	now.allocations = df->arena->allocations;
+	now.alloc_bytes = df->arena->allocated;
+	reset_arena_peak(df->arena);
+	for(int k = 0; k < df->nb_inputs; k++)
+	{
+		a = df->in[k].ef->arena;
+		now.syscalls    += df->in[k].ef->nb_syscalls;
+		now.bytes_read  += df->in[k].ef->bytes_viewed;
+		now.allocations += a->allocations;
+		now.alloc_bytes += a->allocated;
+		peak            += a->peak;
+		reset_arena_peak(a);
+	}
+	if(img != NULL)
+	{
+		now.syscalls      += img->nb_syscalls;
+		now.bytes_read    += img->bytes_read;
+		now.bytes_written += img->bytes_written;
+	}
 
-		if((j == secTab2->nb_sections) || (mode == ONLY1))
-		{
-			/* La section est présente uniquement dans le premier fichier */
-			print_debug("Ajout de la section %2i '%s' à l'offset %#x avec une taille de %#x (-> premier fichier uniquement)\n",
-				i, get_section_name(secTab1, i), df->offset, secTab1->shdr[i]->sh_size);
-			df->f[ind]->size = secTab1->shdr[i]->sh_size;
-			df->f[ind]->ptr_shdr2 = NULL;
-		}
-		else
-		{
-			/* La section est présente dans les deux fichiers */
-			print_debug("Ajout de la section %2i '%s' à l'offset %#x avec une taille de %x+%x=%#x (-> deux fichiers)\n",
-				i, get_section_name(secTab2, j), df->offset, secTab1->shdr[i]->sh_size, secTab2->shdr[j]->sh_size, secTab1->shdr[i]->sh_size + secTab2->shdr[j]->sh_size);
-			df->f[ind]->size = secTab1->shdr[i]->sh_size + secTab2->shdr[j]->sh_size;
-			df->f[ind]->ptr_shdr2 = secTab2->shdr[j];
-			df->f[ind]->shdr->sh_size += secTab2->shdr[j]->sh_size;
-		}
+	end_stats_phase(&df->stats, name, unit, items, &now, peak);
+}
 
-		strcpy(df->f[ind]->section, get_section_name(secTab1, i));
-		df->f[ind]->shdr->sh_offset = df->offset;
-		df->offset += df->f[ind]->size;
-		df->range[type].end = ind;
-	}
+static unsigned long count_relocations(Data_fusion *df)
+{
+	unsigned long n = 0;
+	Data_Rel *drel;
 
-	/* On recherche les sections PROGBITS du second fichier qui ne sont pas présentes dans le premier */
-	for(int i = 1; i < secTab2->nb_sections; i++)
+	for(int k = 0; k < df->nb_inputs; k++)
 	{
-		for(j = 0; (j < nb_types) && (secTab2->shdr[i]->sh_type) != types[j]; j++);
-		if(((mode == MERGE_NOT_IN) && (j != nb_types)) || ((mode != MERGE_NOT_IN) && (j == nb_types)))
-			continue;
+		drel = df->in[k].drel;
+		for(unsigned i = 0; i < drel->nb_rel; i++)
+			n += drel->rel[i].nb_entries;
+		for(unsigned i = 0; i < drel->nb_rela; i++)
+			n += drel->rela[i].nb_entries;
+	}
+	return n;
+}
 
-		/* Recherche si la section est absente du premier fichier */
-		for(j = 0; (j < secTab1->nb_sections) && strcmp(get_section_name(secTab1, j), get_section_name(secTab2, i)); j++);
+static int check_input_files(Data_fusion *df)
+{
+	Elf32_Ehdr *ehdr0 = df->in[0].ehdr;
 
-		if(j == secTab1->nb_sections)
+	for(int k = 0; k < df->nb_inputs; k++)
+		if(df->in[k].drel == NULL)
+		{
+			fprintf(stderr, "FATAL : « %s » : %s\n", df->in[k].filename, df->in[k].ef->error);
+			return 3;
+		}
+
+	for(int k = 0; k < df->nb_inputs; k++)
+	{
+		if(get_section_index(df->in[k].secTab, SHT_SYMTAB) == -1)
 		{
-			print_debug("Ajout de la section %2i '%s' à l'offset %#x avec une taille de %#x (-> second fichier uniquement)\n",
-				i, get_section_name(secTab2, i), df->offset, secTab2->shdr[i]->sh_size);
-			df->nb_sections++;
-			ind = df->nb_sections - 1;
-			df->f = realloc(df->f, sizeof(Fusion*) * df->nb_sections);
-			df->f[ind] = malloc(sizeof(Fusion));
-			df->f[ind]->ptr_shdr1 = NULL;
-			df->f[ind]->ptr_shdr2 = secTab2->shdr[i];
-			df->f[ind]->size = secTab2->shdr[i]->sh_size;
-			df->f[ind]->offset = df->offset;
-			strcpy(df->f[ind]->section, get_section_name(secTab2, i));
-			df->offset += df->f[ind]->size;
-			df->f[ind]->shdr = malloc(sizeof(Elf32_Shdr));
-			memcpy(df->f[ind]->shdr, secTab2->shdr[i], sizeof(Elf32_Shdr));
-			df->f[ind]->shdr->sh_offset = df->offset;
-			df->offset += df->f[ind]->size;
-			df->range[type].end = ind;
+			fprintf(stderr, "FATAL : le fichier « %s » n'a pas de table des symboles !\n", df->in[k].filename);
+			return 2;
+		}
+		if((df->in[k].ehdr->e_machine != ehdr0->e_machine) || (df->in[k].ehdr->e_ident[EI_DATA] != ehdr0->e_ident[EI_DATA]))
+		{
+			fprintf(stderr, "FATAL : les fichiers « %s » et « %s » ne sont pas destinés à la même architecture !\n",
+				df->in[0].filename, df->in[k].filename);
+			return 2;
 		}
 	}
+	return 0;
+}
 
-	free(types);
+/* Agrandit un tableau de n éléments pour en ajouter un ; la taille double à chaque puissance de 2 */
+static inline void *grow_array(Arena *a, void *tab, unsigned n, size_t elem_size)
+{
+	if((n == 0) || (n & (n - 1)))
+		return (n == 0) ? arena_alloc(a, elem_size) : tab;
+	return arena_realloc(a, tab, n * elem_size, 2 * n * elem_size);
 }
 
-static Elf32_Section *find_new_section_index_for_one_file(Data_fusion *df, Section_Table *secTab)
+/* Genre de chaque type de section ; un type absent de la table est rangé dans SKIP */
+static const struct
 {
-	int j;
-	Elf32_Section *newsec = malloc(sizeof(Elf32_Section) * secTab->nb_sections);
+	Elf32_Word sh_type;
+	Sections_Type type;
+} section_classes[] =
+{
+	{ SHT_NULL,           NULLSEC  },
+	{ SHT_PROGBITS,       PROGBITS },
+	{ SHT_NOBITS,         PROGBITS },
+	{ SHT_REL,            REL      },
+	{ SHT_RELA,           REL      },
+	{ SHT_ARM_EXIDX,      ARM      },
+	{ SHT_ARM_PREEMPTMAP, ARM      },
+	{ SHT_ARM_ATTRIBUTES, ARM      },
+};
+
+/* Pour chaque genre : fusion des sections de même nom, ou seule la première est gardée */
+static const Gather_Mode gather_modes[TYPES_COUNT] = { ONLY1, MERGE, MERGE, ONLY1, MERGE };
+
+static const char *gather_steps[TYPES_COUNT] =
+{
+	NULL,
+	"fusion des sections PROGBITS",
+	"récupération des sections REL(A)",
+	"récupération des sections ARM",
+	"récupération des autres sections"
+};
+
+static Sections_Type classify_section(Elf32_Word sh_type)
+{
+	for(int i = 0; i < sizeof(section_classes) / sizeof(section_classes[0]); i++)
+		if(section_classes[i].sh_type == sh_type)
+			return section_classes[i].type;
+	return SKIP;
+}
 
-	for(int i = 0; i < secTab->nb_sections; i++)
+static void gather_sections(Data_fusion *df)
+{
+	int ind;
+	unsigned first, nb_refs[TYPES_COUNT] = { 0 };
+	Section_Ref *refs[TYPES_COUNT] = { NULL };
+	Sections_Type type;
+	Section_Table *secTab;
+	Fusion_Part *part;
+	const char *name;
+
+	/* Premier parcours : on range chaque section dans le genre de son type, dans l'ordre des fichiers ;
+	 * la section n°0 n'est prise que dans le premier */
+	for(int k = 0; k < df->nb_inputs; k++)
 	{
-		for(j = 0; (j < df->nb_sections) && strcmp(df->f[j]->section, get_section_name(secTab, i)); j++);
-		newsec[i] = (j < df->nb_sections) ? j : 0;
-		print_debug("Ancienne section %2i <==> %2i nouvelle section\n", i, j);
-		if(j == df->nb_sections)
-			fprintf(stderr, RESET "ATTENTION : la section n°%i « %s » n'apparaît pas dans la nouvelle table des sections !\n", i, get_section_name(secTab, i));
+		secTab = df->in[k].secTab;
+		for(int i = (k == 0) ? 0 : 1; i < secTab->nb_sections; i++)
+		{
+			type = classify_section(secTab->shdr[i]->sh_type);
+			refs[type] = grow_array(df->arena, refs[type], nb_refs[type]++, sizeof(Section_Ref));
+			refs[type][ nb_refs[type] - 1 ] = (Section_Ref) { k, i };
+		}
 	}
 
-	return newsec;
+	/* Second parcours : chaque genre est fusionné à la suite des précédents */
+	for(type = 0; type < TYPES_COUNT; type++)
+	{
+		if(gather_steps[type] != NULL)
+			TRACE(TRACE_SECTIONS, TRACE_STEPS, BOLD "\n==> Étape de %s\n" RESET, gather_steps[type]);
+		first = df->nb_sections;
+		for(int r = 0; r < nb_refs[type]; r++)
+		{
+			const unsigned k = refs[type][r].input, i = refs[type][r].index;
+			secTab = df->in[k].secTab;
+
+			/* Recherche si la section est déjà présente dans la nouvelle table des sections */
+			name = get_section_name(secTab, i);
+			ind  = find_in_name_index(df->section_index, name);
+
+			if(ind != -1)
+			{
+				if((ind < first) || (gather_modes[type] == ONLY1))
+				{
+					TRACE(TRACE_SECTIONS, TRACE_DETAIL, "Section %2i '%s' du fichier %i ignorée (-> déjà présente)\n", i, name, k + 1);
+					continue;
+				}
+
+				/* La section est déjà présente, on l'ajoute à la suite */
+				TRACE(TRACE_SECTIONS, TRACE_DETAIL, "Ajout de la section %2i '%s' du fichier %i à la suite de la section %2i avec une taille de %#x\n",
+					i, name, k + 1, ind, secTab->shdr[i]->sh_size);
+				df->f[ind]->parts = grow_array(df->arena, df->f[ind]->parts, df->f[ind]->nb_parts++, sizeof(Fusion_Part));
+			}
+			else
+			{
+				/* La section est nouvelle */
+				TRACE(TRACE_SECTIONS, TRACE_DETAIL, "Ajout de la section %2i '%s' du fichier %i avec une taille de %#x\n",
+					i, name, k + 1, secTab->shdr[i]->sh_size);
+				ind = df->nb_sections;
+				add_in_name_index(df->section_index, name, ind);
+				df->f = grow_array(df->arena, df->f, df->nb_sections++, sizeof(Fusion*));
+				df->f[ind] = arena_alloc(df->arena, sizeof(Fusion));
+				df->f[ind]->nb_parts = 1;
+				df->f[ind]->parts    = arena_alloc(df->arena, sizeof(Fusion_Part));
+				df->f[ind]->size     = 0;
+				df->f[ind]->offset   = 0;
+				df->f[ind]->shdr     = arena_alloc(df->arena, sizeof(Elf32_Shdr));
+				memcpy(df->f[ind]->shdr, secTab->shdr[i], sizeof(Elf32_Shdr));
+				df->f[ind]->section  = name;
+			}
+
+			part = &df->f[ind]->parts[ df->f[ind]->nb_parts - 1 ];
+			part->input = k;
+			part->index = i;
+			part->shdr  = secTab->shdr[i];
+			part->shift = 0;
+			part->data  = NULL;
+			part->patches    = NULL;
+			part->nb_patches = 0;
+		}
+
+		df->range[type].start = first;
+		df->range[type].end   = df->nb_sections - 1;
+	}
 }
 
-void find_new_section_index(Data_fusion *df, Section_Table *secTab1, Section_Table *secTab2)
+static inline Elf32_Word align_offset(Elf32_Word offset, Elf32_Word align)
 {
-	df->newsec1 = find_new_section_index_for_one_file(df, secTab1);
-	df->newsec2 = find_new_section_index_for_one_file(df, secTab2);
+	return (align > 1) ? (offset + align - 1) / align * align : offset;
 }
 
-static void update_section_index_in_section(Elf32_Shdr *section, Elf32_Section *newsec, unsigned nb_sections)
+static void layout_sections(Data_fusion *df)
 {
-	if((section->sh_link >= nb_sections) || (section->sh_info >= nb_sections))
-		return;
-	print_debug("La section qui pointait vers les sections LN %2i et Inf %2i pointe dorénavant vers les indices %2i et %2i\n",
-		section->sh_link, section->sh_info, newsec[section->sh_link], newsec[section->sh_info]);
-	section->sh_link = newsec[section->sh_link];
-	section->sh_info = newsec[section->sh_info];
+	Fusion *f;
+	Elf32_Word size, align;
+
+	df->offset = sizeof(Elf32_Ehdr);
+	for(int i = 1; i < df->nb_sections; i++)
+	{
+		f     = df->f[i];
+		size  = 0;
+		align = f->shdr->sh_addralign;
+
+		/* Chaque partie garde l'alignement qu'elle avait dans son fichier */
+		for(int p = 0; p < f->nb_parts; p++)
+		{
+			size = align_offset(size, f->parts[p].shdr->sh_addralign);
+			f->parts[p].shift = size;
+			df->in[ f->parts[p].input ].shift[ f->parts[p].index ] = size;
+			size += f->parts[p].shdr->sh_size;
+			if(f->parts[p].shdr->sh_addralign > align)
+				align = f->parts[p].shdr->sh_addralign;
+		}
+
+		/* Une section NOBITS n'occupe pas de place dans le fichier */
+		df->offset = align_offset(df->offset, align);
+		f->size    = size;
+		f->offset  = df->offset;
+		f->shdr->sh_offset    = df->offset;
+		f->shdr->sh_size      = size;
+		f->shdr->sh_addralign = align;
+		if(f->shdr->sh_type != SHT_NOBITS)
+			df->offset += size;
+		TRACE(TRACE_SECTIONS, TRACE_DETAIL, "Section %2i '%s' placée à l'offset %#x avec une taille de %#x (%u partie(s))\n",
+			i, f->section, f->offset, f->size, f->nb_parts);
+	}
+
+	/* La table des en-têtes de section suit les sections */
+	df->offset = align_offset(df->offset, 4);
 }
 
-static void update_section_index_in_sections(Data_fusion *df)
+static void find_new_section_index_for_one_file(Data_fusion *df, Input_File *in)
 {
-	for(int i = 1; i < df->nb_sections; i++)
+	int j;
+	Section_Table *secTab = in->secTab;
+	in->newsec = arena_alloc(in->ef->arena, sizeof(Elf32_Section) * secTab->nb_sections);
+
+	for(int i = 0; i < secTab->nb_sections; i++)
 	{
-		if(df->f[i]->ptr_shdr1 != NULL)
-			update_section_index_in_section(df->f[i]->shdr, df->newsec1, df->nb_sections);
-		else
-			update_section_index_in_section(df->f[i]->shdr, df->newsec2, df->nb_sections);
+		j = find_in_name_index(df->section_index, get_section_name(secTab, i));
+		in->newsec[i] = (j != -1) ? j : 0;
+		TRACE(TRACE_SECTIONS, TRACE_DETAIL, "Ancienne section %2i <==> %2i nouvelle section\n", i, j);
+		if(j == -1)
+			fprintf(stderr, RESET "ATTENTION : la section n°%i « %s » du fichier « %s » n'apparaît pas dans la nouvelle table des sections !\n",
+				i, get_section_name(secTab, i), in->filename);
 	}
 }
 
-static void update_section_index_in_symbol(Elf32_Sym *symbol, Elf32_Section *newsec, unsigned nb_sections)
+void find_new_section_index(Data_fusion *df)
 {
-	if((symbol->st_shndx >= nb_sections) || (symbol->st_shndx == SHN_UNDEF) || (symbol->st_shndx == SHN_ABS))
-		return;
-	if(newsec[symbol->st_shndx] == 0)
-		fprintf(stderr, RESET "ATTENTION : le symbole qui pointait vers la section %i ne pointe plus vers de section !\n", symbol->st_shndx);
-	print_debug("Le symbole qui pointait vers l'indice %2i pointe dorénavant vers l'indice %2i\n", symbol->st_shndx, newsec[symbol->st_shndx]);
-	symbol->st_shndx = newsec[symbol->st_shndx];
+	for(int k = 0; k < df->nb_inputs; k++)
+		find_new_section_index_for_one_file(df, &df->in[k]);
 }
 
-static int find_index_in_name_table(char *haystack, char *needle, Elf32_Word size)
+static void update_section_index_in_section(Elf32_Shdr *section, Input_File *in)
 {
-	int i;
+	unsigned nb_sections = in->secTab->nb_sections;
 
-	if(strlen(needle) <= 0)
-		return -1;
-	for(i = 0; (i < size) && strcmp(&(haystack[i]), needle); i += strlen(&(haystack[i])) + 1);
+	TRACE(TRACE_SECTIONS, TRACE_DETAIL, "La section qui pointait vers les sections LN %2i et Inf %2i ", section->sh_link, section->sh_info);
+	if(section->sh_link < nb_sections)
+		section->sh_link = in->newsec[section->sh_link];
 
-	return (i < size) ? i : -1;
+	/* sh_info ne désigne une section que pour les réimplantations (sinon, c'est un nombre de symboles par exemple) */
+	if(((section->sh_type == SHT_REL) || (section->sh_type == SHT_RELA) || (section->sh_flags & SHF_INFO_LINK)) && (section->sh_info < nb_sections))
+		section->sh_info = in->newsec[section->sh_info];
+	TRACE(TRACE_SECTIONS, TRACE_DETAIL, "pointe dorénavant vers les indices %2i et %2i\n", section->sh_link, section->sh_info);
 }
 
-static int add_symbol_in_table(Symtab_Struct *st, Elf32_Sym *symtab)
+static void update_section_index_in_sections(Data_fusion *df)
 {
-	int ind = st->nbSymbol;
+	for(int i = 1; i < df->nb_sections; i++)
+		update_section_index_in_section(df->f[i]->shdr, &df->in[ df->f[i]->parts[0].input ]);
+}
 
-	st->nbSymbol++;
-	st->tab = realloc(st->tab, sizeof(Elf32_Sym*) * st->nbSymbol);
-	st->tab[ind] = malloc(sizeof(Elf32_Sym));
-	memcpy(st->tab[ind], symtab, sizeof(Elf32_Sym));
+static void update_section_index_in_symbol(Elf32_Sym *symbol, Input_File *in)
+{
+	if((symbol->st_shndx >= in->secTab->nb_sections) || (symbol->st_shndx == SHN_UNDEF) || (symbol->st_shndx == SHN_ABS))
+		return;
+	if(in->newsec[symbol->st_shndx] == 0)
+		fprintf(stderr, RESET "ATTENTION : le symbole qui pointait vers la section %i ne pointe plus vers de section !\n", symbol->st_shndx);
+	TRACE(TRACE_SYMBOLS, TRACE_DETAIL, "Le symbole qui pointait vers l'indice %2i pointe dorénavant vers l'indice %2i\n", symbol->st_shndx, in->newsec[symbol->st_shndx]);
 
-	return ind;
+	/* La valeur d'un symbole est relative au début de sa section, qui a pu être décalée */
+	if(ELF32_ST_TYPE(symbol->st_info) != STT_SECTION)
+		symbol->st_value += in->shift[symbol->st_shndx];
+	symbol->st_shndx = in->newsec[symbol->st_shndx];
 }
 
-static int merge_and_fix_symbols(Data_fusion *df, Section_Table *secTab1, Section_Table *secTab2, symbolTable *st1, symbolTable *st2, Symtab_Struct *st_out)
+static int merge_and_fix_symbols(Data_fusion *df, Symtab_Struct *st_out)
 {
-	int ind, j, shndx;
+	int ind, err = 0;
 	char *buff;
-	df->symbolNameTable_size = secTab1->shdr[st1->symtab->strIndex]->sh_size;
+	Input_File *in;
+	Elf32_Sym *sym;
+	Arena_Mark mark = get_arena_mark(df->arena);
+	int *section_symbol = arena_alloc(df->arena, sizeof(int) * df->nb_sections);
+	Name_Index *ni = create_name_index(st_out->nbSymbol);
+
+	for(int i = 0; i < df->nb_sections; i++)
+		section_symbol[i] = -1;
+
+	/* Nouvel indice de chaque symbole d'entrée, dans l'arène de son fichier : il sert jusqu'aux réimplantations */
+	for(int k = 0; k < df->nb_inputs; k++)
+	{
+		df->in[k].newsym = arena_alloc(df->in[k].ef->arena, df->in[k].st->symtab->nbSymbol * sizeof(Elf32_Word));
+		if(df->in[k].st->symtab->nbSymbol > 0)
+			df->in[k].newsym[0] = 0;
+	}
 
-	for(int i = 1; i < st2->symtab->nbSymbol; i++)
+	/* On place les noms des symboles du premier fichier (pris dans sa projection, qui ne bouge pas)
+	 * dans la nouvelle table des noms de symboles ; seuls les symboles non locaux sont indexés,
+	 * car ce sont les seuls qui peuvent être résolus entre les fichiers */
+	for(int i = 1; i < st_out->nbSymbol; i++)
 	{
-		buff = get_static_symbol_name(st2, i);
-		shndx = find_index_in_name_table(st_out->symbolNameTable, buff, df->symbolNameTable_size);
+		buff = get_static_symbol_name(df->in[0].st, i);
+		df->in[0].newsym[i] = i;
+		st_out->tab[i].st_name = add_in_str_table(df->strtab, buff);
+		if((ELF32_ST_BIND(st_out->tab[i].st_info) != STB_LOCAL) && (buff[0] != '\0'))
+			add_in_name_index(ni, buff, i);
+		if((ELF32_ST_TYPE(st_out->tab[i].st_info) == STT_SECTION) && (st_out->tab[i].st_shndx < df->nb_sections))
+			section_symbol[ st_out->tab[i].st_shndx ] = i;
+	}
 
-		if(shndx > 0)
+	for(int k = 1; (k < df->nb_inputs) && !err; k++)
+	{
+		in = &df->in[k];
+		for(int i = 1; i < in->st->symtab->nbSymbol; i++)
 		{
-			/* On calcule l'indice correspondant au symbole déjà présent en se basant sur son nom */
-			for(ind = 0; (ind < st_out->nbSymbol) && strcmp(get_symbol_name(st_out->tab, st_out->symbolNameTable, ind), buff); ind++);
-			const int is_global_st_out = (ELF32_ST_BIND(st_out->tab[ind]->st_info)    == STB_GLOBAL);
-			const int is_global_st2    = (ELF32_ST_BIND(st2->symtab->tab[i]->st_info) == STB_GLOBAL);
+			sym  = &in->st->symtab->tab[i];
+			buff = get_static_symbol_name(in->st, i);
+			ind  = ((ELF32_ST_BIND(sym->st_info) != STB_LOCAL) && (buff[0] != '\0')) ? find_in_name_index(ni, buff) : -1;
 
-			if(is_global_st_out && is_global_st2 && (st_out->tab[ind]->st_shndx != SHN_UNDEF) && (st2->symtab->tab[i]->st_shndx != SHN_UNDEF))
+			if(ind != -1)
 			{
-				/* Un symbole global est défini deux fois, on abandonne... */
-				fprintf(stderr, "FATAL : le symbole « %s » est défini plus d'une fois !\n", buff);
-				return 3;
+				/* Un symbole non local du même nom est déjà présent à l'indice ind */
+				const int is_global_st_out = (ELF32_ST_BIND(st_out->tab[ind].st_info) == STB_GLOBAL);
+				const int is_global_in     = (ELF32_ST_BIND(sym->st_info)              == STB_GLOBAL);
+				const int is_defined_st_out = (st_out->tab[ind].st_shndx != SHN_UNDEF);
+				const int is_defined_in     = (sym->st_shndx             != SHN_UNDEF);
+
+				if(is_global_st_out && is_global_in && is_defined_st_out && is_defined_in)
+				{
+					/* Un symbole global est défini deux fois, on abandonne... */
+					fprintf(stderr, "FATAL : le symbole « %s » est défini plus d'une fois !\n", buff);
+					err = 3;
+					break;
+				}
+				else if(is_defined_in && (!is_defined_st_out || (is_global_in && !is_global_st_out)))
+				{
+					/* On remplace le symbole indéfini (ou faible) par le défini, sans toucher à st_name */
+					TRACE(TRACE_SYMBOLS, TRACE_DETAIL, "Remplace le symbole %2i '%s' par sa version définie dans le fichier %i\n", ind, buff, k + 1);
+					st_out->tab[ind].st_value = sym->st_value;
+					st_out->tab[ind].st_size  = sym->st_size;
+					st_out->tab[ind].st_info  = sym->st_info;
+					st_out->tab[ind].st_other = sym->st_other;
+					st_out->tab[ind].st_shndx = sym->st_shndx;
+					update_section_index_in_symbol(&st_out->tab[ind], in);
+				}
+				in->newsym[i] = ind;
 			}
-			else if(is_global_st_out && is_global_st2 && (st_out->tab[ind]->st_shndx == SHN_UNDEF) && (st2->symtab->tab[i]->st_shndx != SHN_UNDEF))
+			else if((ELF32_ST_TYPE(sym->st_info) == STT_SECTION) && (sym->st_shndx < in->secTab->nb_sections)
+				&& (section_symbol[ in->newsec[sym->st_shndx] ] != -1))
 			{
-				/* On remplace le symbole global indéfini par le défini, sans toucher à st_name */
-				print_debug("Remplace le symbole global %2i '%s' par sa version définie\n", i, get_static_symbol_name(st2, i));
-				st_out->tab[ind]->st_value = st2->symtab->tab[i]->st_value;
-				st_out->tab[ind]->st_size  = st2->symtab->tab[i]->st_size;
-				st_out->tab[ind]->st_info  = st2->symtab->tab[i]->st_info;
-				st_out->tab[ind]->st_other = st2->symtab->tab[i]->st_other;
-				st_out->tab[ind]->st_shndx = st2->symtab->tab[i]->st_shndx;
-				update_section_index_in_symbol(st_out->tab[ind], df->newsec2, df->nb_sections);
+				/* La nouvelle section a déjà son symbole de section */
+				TRACE(TRACE_SYMBOLS, TRACE_DETAIL, "Symbole de section %i du fichier %i déjà présent\n", i, k + 1);
+				in->newsym[i] = section_symbol[ in->newsec[sym->st_shndx] ];
 			}
-			else if(!is_global_st_out && !is_global_st2)
+			else
 			{
-				/* Un autre symbole local a le même nom, on ajoute le symbole à la table des symboles uniquement */
-				print_debug("Ajout du symbole local %i '%s' dans la table des symboles uniquement\n", i, get_static_symbol_name(st2, i));
-				ind = add_symbol_in_table(st_out, st2->symtab->tab[i]);
-				st_out->tab[ind]->st_name = shndx;
-				update_section_index_in_symbol(st_out->tab[ind], df->newsec2, df->nb_sections);
-
-				/* On met à jour la valeur du nouveau symbole */
-				for(j = 0; (j < secTab1->nb_sections) && df->newsec2[ st2->symtab->tab[i]->st_shndx ] != df->newsec1[j]; j++);
-				if(j < secTab1->nb_sections)
-					st_out->tab[ind]->st_value += secTab1->shdr[j]->sh_size;
+				/* On ajoute le symbole à la nouvelle table */
+				TRACE(TRACE_SYMBOLS, TRACE_DETAIL, "Ajout du symbole %i '%s' du fichier %i à la table des symboles\n", i, buff, k + 1);
+				ind = append_symbol(st_out, sym);
+				update_section_index_in_symbol(&st_out->tab[ind], in);
+				in->newsym[i] = ind;
+
+				st_out->tab[ind].st_name = add_in_str_table(df->strtab, buff);
+				if((ELF32_ST_BIND(sym->st_info) != STB_LOCAL) && (buff[0] != '\0'))
+					add_in_name_index(ni, buff, ind);
+				if((ELF32_ST_TYPE(sym->st_info) == STT_SECTION) && (st_out->tab[ind].st_shndx < df->nb_sections))
+					section_symbol[ st_out->tab[ind].st_shndx ] = ind;
 			}
 		}
-		else
-		{
-			j = secTab1->nb_sections;
-			/* On cherche s'il s'agit d'un symbole de section et qu'il n'est pas déjà défini */
-			if((ELF32_ST_BIND(st2->symtab->tab[i]->st_info) == STB_LOCAL) && st2->symtab->tab[i]->st_shndx < secTab2->nb_sections)
-				for(j = 0; (j < secTab1->nb_sections) && df->newsec2[ st2->symtab->tab[i]->st_shndx ] != df->newsec1[j]; j++);
+	}
 
-			if(j == secTab1->nb_sections)
-			{
-				/* On ajoute le symbole à la nouvelle table */
-				print_debug("Ajout du symbole %i '%s' à la table des symboles\n", i, get_static_symbol_name(st2, i));
-				ind = add_symbol_in_table(st_out, st2->symtab->tab[i]);
-				update_section_index_in_symbol(st_out->tab[ind], df->newsec2, df->nb_sections);
+	st_out->symbolNameTable = df->strtab->data;
+	destroy_name_index(ni);
+	release_arena(df->arena, mark);
+	return err;
+}
 
-				if(strlen(buff) > 0)
-				{
-					st_out->tab[ind]->st_name = df->symbolNameTable_size;
-					st_out->symbolNameTable = realloc(st_out->symbolNameTable, df->symbolNameTable_size + strlen(buff) + 1);
-					st_out->symbolNameTable[df->symbolNameTable_size] = '\0';
-					strcat(&(st_out->symbolNameTable[df->symbolNameTable_size]), buff);
-					df->symbolNameTable_size += strlen(buff) + 1;
-				}
-			}
+static void update_relocations_info(Elf32_Rel *rel, unsigned nb_entries, const Input_File *in, Elf32_Word shift)
+{
+	const Elf32_Word *newsym = in->newsym;
+	const Elf32_Word nb_symbols = in->st->symtab->nbSymbol;
+
+	/* Un chargement par entrée, sans appel ni branchement : la boucle peut être vectorisée ;
+	 * un indice de symbole invalide est laissé tel quel */
+	for(unsigned e = 0; e < nb_entries; e++)
+	{
+		Elf32_Word sym = ELF32_R_SYM(rel[e].r_info);
+		sym = (sym < nb_symbols) ? newsym[sym] : sym;
+		rel[e].r_info    = ELF32_R_INFO(sym, ELF32_R_TYPE(rel[e].r_info));
+		rel[e].r_offset += shift;
+	}
+}
+
+static void update_relocations_info_rela(Elf32_Rela *rela, unsigned nb_entries, const Input_File *in, Elf32_Word shift)
+{
+	const Elf32_Word *newsym = in->newsym;
+	const Elf32_Sym *tab = in->st->symtab->tab;
+	const Elf32_Word nb_symbols = in->st->symtab->nbSymbol;
+
+	/* La valeur ajoutée est explicite : elle est corrigée dans la même passe que l'indice du symbole */
+	for(unsigned e = 0; e < nb_entries; e++)
+	{
+		Elf32_Word sym = ELF32_R_SYM(rela[e].r_info);
+		if(sym < nb_symbols)
+		{
+			if((ELF32_ST_TYPE(tab[sym].st_info) == STT_SECTION) && (tab[sym].st_shndx < in->secTab->nb_sections))
+				rela[e].r_addend += in->shift[ tab[sym].st_shndx ];
+			sym = newsym[sym];
 		}
+		rela[e].r_info    = ELF32_R_INFO(sym, ELF32_R_TYPE(rela[e].r_info));
+		rela[e].r_offset += shift;
 	}
+}
+
+static int get_implicit_addend_field(Elf32_Half machine, Elf32_Word type, Implicit_Field *field)
+{
+	/* Par défaut, la valeur occupe un mot entier */
+	*field = (Implicit_Field) { sizeof(Elf32_Word), 0xffffffff, 0 };
 
+	if(machine == EM_ARM)
+		switch(type)
+		{
+			case R_ARM_ABS32_NOI:
+			case R_ARM_ABS32:
+			case R_ARM_REL32:
+				return 1;
+			case R_ARM_ABS16:
+				*field = (Implicit_Field) { 2, 0xffff, 0 };
+				return 1;
+			case R_ARM_ABS12:
+				field->mask = 0x00000fff;
+				return 1;
+			case R_ARM_ABS8:
+				*field = (Implicit_Field) { 1, 0xff, 0 };
+				return 1;
+			case R_ARM_PC24:
+			case R_ARM_JUMP24:
+			case R_ARM_CALL:
+				field->mask   = 0x00ffffff;
+				field->rshift = 2;
+				return 1;
+		}
+	else if(machine == EM_386)
+		switch(type)
+		{
+			case R_386_32:
+			case R_386_PC32:
+				return 1;
+		}
 	return 0;
 }
 
-static void update_relocations_info_for_one_file(Data_Rel *drel, Elf32_Section *newsec, symbolTable *st)
+static void fix_implicit_addend(Arena *arena, Fusion_Part *part, Input_File *in, Elf32_Word r_offset, Elf32_Word type, Elf32_Word shift)
 {
-	for(int i = 0; i < drel->nb_rel; i++)
-		for(int j = 0; j < drel->e_rel[i]; j++)
-				drel->rel[i][j]->r_info = ELF32_R_INFO(newsec[  st->symtab->tab[ ELF32_R_SYM(drel->rel[i][j]->r_info) ]->st_shndx  ],
-				                                       ELF32_R_TYPE(drel->rel[i][j]->r_info));
+	Implicit_Field field;
+	Implicit_Patch *patch = NULL;
+	unsigned char *dst;
+	Elf32_Word value;
+
+	if(!get_implicit_addend_field(in->ehdr->e_machine, type, &field))
+	{
+		fprintf(stderr, "ATTENTION : le type de réimplémentation %i n'est pas pris en charge !\n", type);
+		return;
+	}
+	if((part->shdr->sh_type == SHT_NOBITS) || (r_offset > part->shdr->sh_size) || (part->shdr->sh_size - r_offset < field.size))
+	{
+		fprintf(stderr, "ATTENTION : la réimplantation à l'adresse de décalage %#x sort de sa section !\n", r_offset);
+		return;
+	}
+
+	/* Passé MAX_PART_PATCHES correctifs, la partie est recopiée en mémoire avec ses correctifs ;
+	 * elle sera écrite depuis cette copie */
+	if((part->data == NULL) && (part->nb_patches == MAX_PART_PATCHES))
+	{
+		part->data = arena_alloc(arena, part->shdr->sh_size);
+		memcpy(part->data, get_elf_view_or_die(in->ef, part->shdr->sh_offset, part->shdr->sh_size), part->shdr->sh_size);
+		for(unsigned p = 0; p < part->nb_patches; p++)
+			memcpy(part->data + part->patches[p].offset, part->patches[p].bytes, part->patches[p].size);
+		part->nb_patches = 0;
+	}
+
+	if(part->data != NULL)
+		dst = part->data + r_offset;
+	else
+	{
+		/* Sinon, la partie reste recopiée de fichier à fichier et seule la valeur corrigée est réécrite ;
+		 * une valeur déjà corrigée est reprise de son correctif */
+		for(unsigned p = 0; (p < part->nb_patches) && (patch == NULL); p++)
+			if(part->patches[p].offset == r_offset)
+				patch = &part->patches[p];
+		if(patch == NULL)
+		{
+			part->patches = grow_array(arena, part->patches, part->nb_patches++, sizeof(Implicit_Patch));
+			patch = &part->patches[ part->nb_patches - 1 ];
+			patch->offset = r_offset;
+			patch->size   = field.size;
+			memcpy(patch->bytes, get_elf_view_or_die(in->ef, part->shdr->sh_offset + r_offset, field.size), field.size);
+		}
+		dst = patch->bytes;
+	}
+
+	/* Seuls les bits du champ changent, le reste de l'instruction est conservé */
+	value = decode_elf_value(&in->ef->dec, dst, field.size);
+	value = (value & ~field.mask) | ((value + (shift >> field.rshift)) & field.mask);
+
+	/* Le contenu des sections est recopié tel quel : on garde le boutisme du fichier */
+	if(field.size == sizeof(Elf32_Word))
+	{
+		if(in->ef->dec.swap)
+			value = reverse_4(value);
+		memcpy(dst, &value, sizeof(Elf32_Word));
+	}
+	else if(field.size == sizeof(Elf32_Half))
+	{
+		Elf32_Half half = in->ef->dec.swap ? reverse_2(value) : value;
+		memcpy(dst, &half, sizeof(Elf32_Half));
+	}
+	else
+		*dst = value;
 }
 
-static void update_relocations_info(Data_fusion *df, Data_Rel *drel1, Data_Rel *drel2, symbolTable *st1, symbolTable *st2)
+static Fusion_Part *find_part(Data_fusion *df, unsigned input, unsigned index)
 {
-	update_relocations_info_for_one_file(drel1, df->newsec1, st1);
-	update_relocations_info_for_one_file(drel2, df->newsec2, st2);
+	Fusion *f = df->f[ df->in[input].newsec[index] ];
+
+	for(int p = 0; p < f->nb_parts; p++)
+		if((f->parts[p].input == input) && (f->parts[p].index == index))
+			return &f->parts[p];
+	return NULL;
 }
 
-static void merge_and_fix_relocations(Data_fusion *df, int fd2, int fd_out, Section_Table *secTab1, Section_Table *secTab2, Data_Rel *drel1, Data_Rel *drel2)
+static void merge_and_fix_relocations(Data_fusion *df, Out_Image *img)
 {
-	int ind, j;
-
-	/* On concatène les tables de réimplantations de drel2 dans drel1 */
-	for(int i = 0; i < drel2->nb_rel; i++)
+	Fusion *f;
+	Fusion_Part *target_part;
+	Input_File *in;
+	Rel_Section *s;
+	Elf32_Rel *rel;
+	Elf32_Sym *sym;
+	Elf32_Word target, shift;
+	int is_rela;
+
+	for(int i = df->range[REL].start; i <= df->range[REL].end; i++)
 	{
-		for(j = 0; (j < drel1->nb_rel) && df->newsec2[ drel2->i_rel[i] ] != df->newsec1[ drel1->i_rel[j] ]; j++);
-		if(j < drel1->nb_rel)
+		f = df->f[i];
+		if((f->shdr->sh_type != SHT_REL) && (f->shdr->sh_type != SHT_RELA))
+			continue;
+		is_rela = (f->shdr->sh_type == SHT_RELA);
+
+		/* Chaque partie est écrite à son décalage dans la section fusionnée */
+		for(int p = 0; p < f->nb_parts; p++)
 		{
-			/* La section REL était déjà présente dans le premier fichier, on ajoute à la suite celle-ci */
-			print_debug("Concatène la section REL %2i '%s' avec celle du premier fichier\n", i, get_section_name(secTab2, drel2->i_rel[i]));
-			ind = drel1->e_rel[j];
-			drel1->e_rel[j] += drel2->e_rel[i];
-			drel1->a_rel[j]  = df->f[  df->newsec2[ drel2->i_rel[i] ]  ]->shdr->sh_offset;
-			drel1->rel[j]    = realloc(drel1->rel[j], sizeof(Elf32_Rel*) * drel1->e_rel[j]);
-			Elf32_Sword addend[1<<16];
-			for(int k = 0; k < drel2->e_rel[i]; k++)
+			in = &df->in[ f->parts[p].input ];
+			if((s = find_rel_section(in->drel, f->parts[p].index, is_rela)) == NULL)
+				continue;
+
+			target = f->parts[p].shdr->sh_info;
+			shift  = (target < in->secTab->nb_sections) ? in->shift[target] : 0;
+			target_part = (target < in->secTab->nb_sections) ? find_part(df, f->parts[p].input, target) : NULL;
+			TRACE(TRACE_RELOCS, TRACE_DETAIL, "Ajout de la section %s %2i '%s' du fichier %i (cible décalée de %#x)\n",
+				is_rela ? "RELA" : "REL", s->index, f->section, f->parts[p].input + 1, shift);
+
+			if(is_rela)
+				update_relocations_info_rela(s->rela, s->nb_entries, in, shift);
+			else
 			{
-				drel1->rel[j][ind] = malloc(sizeof(Elf32_Rel));
-				memcpy(drel1->rel[j][ind], drel2->rel[i][k], sizeof(Elf32_Rel));
-				drel1->rel[j][ind]->r_offset += secTab1->shdr[  secTab1->shdr[ drel1->i_rel[j] ]->sh_info  ]->sh_size;
-
-				lseek(fd2, secTab2->shdr[ drel2->i_rel[i] ]->sh_offset + drel2->rel[i][k]->r_offset, SEEK_SET);
-				read(fd2, &addend, sizeof(Elf32_Sword));
-				switch(ELF32_R_TYPE(drel2->rel[i][k]->r_info))
+				/* Les symboles de section des fichiers suivants désignent maintenant le début de la section fusionnée :
+				 * on corrige d'abord les valeurs implicites, avant que les indices de symbole ne soient renumérotés */
+				for(int e = 0; (e < s->nb_entries) && (target_part != NULL); e++)
 				{
-					case R_ARM_ABS32_NOI:
-					case R_ARM_ABS32:
-					case R_ARM_ABS16:
-					case R_ARM_ABS12:
-					case R_ARM_ABS8:
-						addend[k] = df->f[    df->newsec2[  secTab2->shdr[ drel2->i_rel[i] ]->sh_link  ]    ]->ptr_shdr1->sh_size;
-						break;
-					case R_ARM_JUMP24:
-					case R_ARM_CALL:
-						addend[k] = (df->f[    df->newsec2[  secTab2->shdr[ drel2->i_rel[i] ]->sh_link  ]    ]->ptr_shdr1->sh_size >> 2);
-						break;
-					default:
-						fprintf(stderr, "ATTENTION : le type de réimplémentation %i n'est pas pris en charge !\n", ELF32_R_TYPE(drel2->rel[i][k]->r_info));
+					rel = &s->rel[e];
+					sym = (ELF32_R_SYM(rel->r_info) < in->st->symtab->nbSymbol) ? &in->st->symtab->tab[ ELF32_R_SYM(rel->r_info) ] : NULL;
+					if((sym != NULL) && (ELF32_ST_TYPE(sym->st_info) == STT_SECTION) && (sym->st_shndx < in->secTab->nb_sections)
+						&& (in->shift[sym->st_shndx] != 0))
+						fix_implicit_addend(df->arena, target_part, in, rel->r_offset, ELF32_R_TYPE(rel->r_info), in->shift[sym->st_shndx]);
 				}
-				ind++;
+				update_relocations_info(s->rel, s->nb_entries, in, shift);
 			}
-			write_new_relocation_table_in_file(fd_out, drel1, j);
-			for(int k = 0; k < drel2->e_rel[i]; k++)
-			{
-				lseek(fd_out, df->f[  df->newsec2[ drel2->i_rel[i] ]  ]->shdr->sh_offset + drel2->rel[i][k]->r_offset, SEEK_SET);
-				write(fd_out, &addend[k], sizeof(Elf32_Sword));
-			}
-		}
-		else
-		{
-			/* La section est absente du premier fichier, on l'ajoute telle quelle */
-			print_debug("Ajout de la section REL %2i '%s' à la table de réimplantations\n", i, get_section_name(secTab2, drel2->i_rel[i]));
-			ind = drel1->nb_rel;
-			drel1->nb_rel++;
-			drel1->e_rel      = realloc(drel1->e_rel, sizeof(unsigned) * drel1->nb_rel);
-			drel1->a_rel      = realloc(drel1->a_rel, sizeof(unsigned) * drel1->nb_rel);
-			drel1->i_rel      = realloc(drel1->i_rel, sizeof(unsigned) * drel1->nb_rel);
-			drel1->e_rel[ind] = drel2->e_rel[i];
-			drel1->a_rel[ind] = drel2->a_rel[i];
-			drel1->i_rel[ind] = drel2->i_rel[i];
-			drel1->rel        = realloc(drel1->rel, sizeof(Elf32_Rel*) * drel1->nb_rel);
-			drel1->rel[ind]   = malloc(sizeof(Elf32_Rel*) * drel1->e_rel[ind]);
-			for(int k = 0; k < drel1->e_rel[ind]; k++)
-			{
-				drel1->rel[ind][k] = malloc(sizeof(Elf32_Rel));
-				memcpy(drel1->rel[ind][k], drel2->rel[i][k], sizeof(Elf32_Rel));
-			}
-			write_new_relocation_table_in_file(fd_out, drel1, ind);
-		}
 
+			s->offset = f->offset + f->parts[p].shift;
+			write_new_relocation_table_in_file(img, &df->dec, s);
+		}
 	}
 }
 
 
-static inline void swap_symbols(Elf32_Sym *sym1, Elf32_Sym *sym2)
+/* Rang d'un symbole dans la table triée : symboles de section, autres symboles locaux, puis globaux */
+static inline int symbol_class(const Elf32_Sym *sym)
 {
-	Elf32_Sym *tmp = malloc(sizeof(Elf32_Sym));
-	memcpy(tmp, sym2, sizeof(Elf32_Sym));
-	memcpy(sym2, sym1, sizeof(Elf32_Sym));
-	memcpy(sym1, tmp, sizeof(Elf32_Sym));
-	free(tmp);
+	if(ELF32_ST_BIND(sym->st_info) != STB_LOCAL)
+		return 2;
+	return (ELF32_ST_TYPE(sym->st_info) == STT_SECTION) ? 0 : 1;
 }
 
-static void sort_new_symbol_table(Symtab_Struct *st)
+static void sort_new_symbol_table(Data_fusion *df, Symtab_Struct *st)
 {
-	int j, cpt = 0;
+	unsigned count[3] = { 0, 0, 0 }, next[3];
+	Elf32_Sym *sorted;
+
+	df->sorted_index = arena_alloc(df->arena, st->nbSymbol * sizeof(Elf32_Word));
+	df->sorted_index[0] = 0;
 
+	/* Partition stable en deux passes : on compte chaque classe, puis on place chaque symbole
+	 * à la suite de ceux de sa classe ; le symbole nul reste en tête */
+	for(int i = 1; i < st->nbSymbol; i++)
+		count[symbol_class(&st->tab[i])]++;
+	next[0] = 1;
+	next[1] = next[0] + count[0];
+	next[2] = next[1] + count[1];
+	df->first_global = next[2];
+
+	Arena_Mark mark = get_arena_mark(df->arena);
+	sorted = arena_alloc(df->arena, st->nbSymbol * sizeof(Elf32_Sym));
+	sorted[0] = st->tab[0];
 	for(int i = 1; i < st->nbSymbol; i++)
 	{
-		if(ELF32_ST_TYPE(st->tab[i]->st_info) == STT_SECTION)
-		{
-			cpt++;
-			continue;
-		}
-
-		for(j = i; (j < st->nbSymbol) && ELF32_ST_TYPE(st->tab[j]->st_info) != STT_SECTION; j++);
-		if(j == st->nbSymbol)
-			continue;
-
-		swap_symbols(st->tab[i], st->tab[j]);
-		cpt++;
+		unsigned j = next[symbol_class(&st->tab[i])]++;
+		sorted[j] = st->tab[i];
+		df->sorted_index[i] = j;
 	}
+	memcpy(st->tab + 1, sorted + 1, (st->nbSymbol - 1) * sizeof(Elf32_Sym));
+	release_arena(df->arena, mark);
 
-	for(int i = cpt; i < st->nbSymbol; i++)
-	{
-		if(ELF32_ST_BIND(st->tab[i]->st_info) != STB_GLOBAL)
-			continue;
-
-		for(j = st->nbSymbol - 1; (j >= i) && ELF32_ST_BIND(st->tab[j]->st_info) == STB_GLOBAL; j--);
-		if(j < i)
-			continue;
+	/* Les tables de correspondance des fichiers d'entrée désignent maintenant la table triée */
+	for(int k = 0; k < df->nb_inputs; k++)
+		for(int i = 1; i < df->in[k].st->symtab->nbSymbol; i++)
+			df->in[k].newsym[i] = df->sorted_index[ df->in[k].newsym[i] ];
 
-		swap_symbols(st->tab[i], st->tab[j]);
-	}
+	TRACE(TRACE_SYMBOLS, TRACE_STEPS, "%i symboles triés, premier symbole global : n°%u\n", st->nbSymbol, df->first_global);
 }
 
-static void write_elf_header_in_file(int fd_out, Elf32_Ehdr *ehdr, Data_fusion *df)
+static void write_elf_header_in_file(Out_Image *img, Elf32_Ehdr *ehdr, Data_fusion *df)
 {
 	ehdr->e_shoff = df->offset;
 	ehdr->e_shnum = df->nb_sections;
 
-	print_debug("Il y a %u sections dans le nouveau fichier ELF créé.\n", ehdr->e_shnum);
-	lseek(fd_out, 0, SEEK_SET);
-	write(fd_out, ehdr->e_ident,      EI_NIDENT);
-	write(fd_out, &ehdr->e_type,      sizeof(ehdr->e_type));
-	write(fd_out, &ehdr->e_machine,   sizeof(ehdr->e_machine));
-	write(fd_out, &ehdr->e_version,   sizeof(ehdr->e_version));
-	write(fd_out, &ehdr->e_entry,     sizeof(ehdr->e_entry));
-	write(fd_out, &ehdr->e_phoff,     sizeof(ehdr->e_phoff));
-	write(fd_out, &ehdr->e_shoff,     sizeof(ehdr->e_shoff));
-	write(fd_out, &ehdr->e_flags,     sizeof(ehdr->e_flags));
-	write(fd_out, &ehdr->e_ehsize,    sizeof(ehdr->e_ehsize));
-	write(fd_out, &ehdr->e_phentsize, sizeof(ehdr->e_phentsize));
-	write(fd_out, &ehdr->e_phnum,     sizeof(ehdr->e_phnum));
-	write(fd_out, &ehdr->e_shentsize, sizeof(ehdr->e_shentsize));
-	write(fd_out, &ehdr->e_shnum,     sizeof(ehdr->e_shnum));
-	write(fd_out, &ehdr->e_shstrndx,  sizeof(ehdr->e_shstrndx));
-}
-
-static void write_given_sections_in_file(Data_fusion *df, int fd1, int fd2, int fd_out, Sections_Type type)
-{
-	off_t old_offset = df->f[ df->range[type].start ]->offset;
-	off_t new_offset = old_offset;
-	lseek(fd_out, old_offset, SEEK_SET);
+	Elf32_Ehdr *out = alloc_out_segment(img, 0, sizeof(Elf32_Ehdr));
+
+	TRACE(TRACE_IO, TRACE_STEPS, "Il y a %u sections dans le nouveau fichier ELF créé.\n", ehdr->e_shnum);
+	*out = *ehdr;
+	if(df->dec.swap)
+		swap_elf32_ehdr(out);
+}
+
+static void write_given_sections_in_file(Data_fusion *df, Out_Image *img, Sections_Type type)
+{
+	Fusion *f;
 
 	for(int i = df->range[type].start; i <= df->range[type].end; i++)
 	{
-		print_debug("Écriture de la section %2i '%s' à l'offset %#x avec une taille de %#x ", i, df->f[i]->section, old_offset, df->f[i]->size);
-		if(df->f[i]->ptr_shdr1 != NULL)
-		{
-			/* On écrit la section du premier fichier */
-			new_offset += write_section_in_file(fd1, fd_out, df->f[i]->ptr_shdr1);
-			if((df->f[i]->ptr_shdr2 != NULL) && (type != ARM)) /* On écrit la section du second fichier */
-				new_offset += write_section_in_file(fd2, fd_out, df->f[i]->ptr_shdr2);
-		}
-		else
-		{
-			/* On écrit uniquement la section du second fichier */
-			new_offset += write_section_in_file(fd2, fd_out, df->f[i]->ptr_shdr2);
-		}
-		print_debug("(%s)\n", (df->f[i]->size == new_offset - old_offset) ? "correcte" : "ERREUR");
-		old_offset = new_offset;
-		df->nb_written++;
+		f = df->f[i];
+		TRACE(TRACE_IO, TRACE_DETAIL, "Écriture de la section %2i '%s' à l'offset %#x avec une taille de %#x\n", i, f->section, f->offset, f->size);
+		for(int p = 0; p < f->nb_parts; p++)
+			add_section_in_image(img, df->in[ f->parts[p].input ].ef, &f->parts[p], f->offset + f->parts[p].shift);
 	}
 }
 
-static ssize_t write_section_in_file(int fd_in, int fd_out, Elf32_Shdr *shdr)
+static void add_section_in_image(Out_Image *img, Elf_File *ef_in, Fusion_Part *part, Elf32_Off offset)
 {
-	ssize_t r, w;
-	unsigned char *buff = malloc(sizeof(unsigned char) * shdr->sh_size);
-
-	lseek(fd_in, shdr->sh_offset, SEEK_SET);
-	r = read(fd_in, buff, shdr->sh_size);
+	/* Une section NOBITS n'a pas de contenu ; les trous laissés pour l'alignement restent à zéro */
+	if(part->shdr->sh_type == SHT_NOBITS)
+		return;
 
-	w = write(fd_out, buff, shdr->sh_size);
-	free(buff);
+	if(part->data != NULL)
+		add_out_segment(img, offset, part->data, part->shdr->sh_size);
+	else
+	{
+		/* Contenu non modifié : il est recopié de fichier à fichier, sans passer par la mémoire ;
+		 * seules ses bornes sont vérifiées (get_elf_view_or_die affiche l'erreur et quitte) */
+		if(!is_in_elf_file(ef_in, part->shdr->sh_offset, part->shdr->sh_size))
+			get_elf_view_or_die(ef_in, part->shdr->sh_offset, part->shdr->sh_size);
+		add_out_file_segment(img, offset, ef_in->fd, part->shdr->sh_offset, part->shdr->sh_size);
+		for(unsigned p = 0; p < part->nb_patches; p++)
+			add_out_patch(img, offset + part->patches[p].offset, part->patches[p].bytes, part->patches[p].size);
+	}
+}
 
-	if(r != w)
-		fprintf(stderr, "ATTENTION : %lu octets ont été lus depuis le fichier d''entrée, mais uniquement %lu ont été écrits.\n", r, w);
-	return w;
+static int find_merged_section(Data_fusion *df, Elf32_Word type)
+{
+	for(int i = 0; i < df->nb_sections; i++)
+		if(df->f[i]->shdr->sh_type == type)
+			return i;
+	return -1;
 }
 
-static void write_new_section_table_in_file(int fd_out, Elf32_Ehdr *ehdr, Data_fusion *df)
+static void write_new_section_table_in_file(Out_Image *img, Elf32_Ehdr *ehdr, Data_fusion *df)
 {
-	int ind;
-	off_t written = 0;
-	off_t old_offset = df->offset;
-	off_t new_offset = old_offset;
+	int ind, symind;
+	Elf32_Shdr *tab;
+	Str_Table *shstrtab;
 
-	for(ind = 0; strcmp(df->f[ind]->section, ".shstrtab"); ind++);
-	ehdr->e_shstrndx = ind;
+	ind = ehdr->e_shstrndx = df->in[0].newsec[ehdr->e_shstrndx];
+	symind = find_merged_section(df, SHT_SYMTAB);
 
-	print_debug("Écriture de la table des noms de section dans le fichier à l'offset %#x\n", df->f[ind]->offset);
-	lseek(fd_out, df->f[ind]->offset, SEEK_SET);
-	for(int i = 0; i < df->nb_sections; i++)
+	/* Si la table des noms de section est aussi celle des noms de symboles, elle est déjà écrite */
+	if((symind == -1) || (df->f[symind]->shdr->sh_link != ind))
 	{
-		df->f[i]->shdr->sh_name = written;
-		written += write(fd_out, df->f[i]->section, strlen(df->f[i]->section) + 1);
+		/* Les noms de section partagent leurs suffixes (".text" est à la fin de ".rel.text") */
+		shstrtab = create_str_table(df->nb_sections);
+		for(int i = 0; i < df->nb_sections; i++)
+			df->f[i]->shdr->sh_name = add_in_str_table(shstrtab, df->f[i]->section);
+		finalize_str_table(shstrtab, 1);
+		for(int i = 0; i < df->nb_sections; i++)
+			df->f[i]->shdr->sh_name = get_str_table_offset(shstrtab, df->f[i]->shdr->sh_name);
+
+		TRACE(TRACE_IO, TRACE_DETAIL, "Écriture de la table des noms de section dans le fichier à l'offset %#x\n", df->f[ind]->offset);
+		df->f[ind]->shdr->sh_size = shstrtab->size;
+		memcpy(alloc_out_segment(img, df->f[ind]->offset, shstrtab->size), shstrtab->data, shstrtab->size);
+		destroy_str_table(shstrtab);
 	}
-	df->f[ind]->shdr->sh_size = written;
 
+	/* Les en-têtes sont regroupés pour être écrits d'un bloc, dans le boutisme du fichier de sortie */
+	tab = alloc_out_segment(img, df->offset, sizeof(Elf32_Shdr) * df->nb_sections);
 	for(int i = 0; i < df->nb_sections; i++)
 	{
-		print_debug("Écriture de l'en-tête de section n°%2i '%s' dans le fichier à l'offset %#x ", i, df->f[i]->section, old_offset);
-		lseek(fd_out, df->offset + i * ehdr->e_shentsize, SEEK_SET);
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_name,      sizeof(df->f[i]->shdr->sh_name));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_type,      sizeof(df->f[i]->shdr->sh_type));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_flags,     sizeof(df->f[i]->shdr->sh_flags));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_addr,      sizeof(df->f[i]->shdr->sh_addr));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_offset,    sizeof(df->f[i]->shdr->sh_offset));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_size,      sizeof(df->f[i]->shdr->sh_size));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_link,      sizeof(df->f[i]->shdr->sh_link));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_info,      sizeof(df->f[i]->shdr->sh_info));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_addralign, sizeof(df->f[i]->shdr->sh_addralign));
-		new_offset += write(fd_out, &df->f[i]->shdr->sh_entsize,   sizeof(df->f[i]->shdr->sh_entsize));
-		print_debug("(%s)\n", (sizeof(Elf32_Shdr) == new_offset - old_offset) ? "correct" : "ERREUR");
-		old_offset = new_offset;
+		TRACE(TRACE_IO, TRACE_DETAIL, "Écriture de l'en-tête de section n°%2i '%s' dans le fichier à l'offset %#x\n",
+			i, df->f[i]->section, df->offset + i * sizeof(Elf32_Shdr));
+		tab[i] = *df->f[i]->shdr;
 	}
+	if(df->dec.swap)
+		swap_elf32_shdr_array(tab, df->nb_sections);
+	ehdr->e_shentsize = sizeof(Elf32_Shdr);
 }
 
-static void write_new_symbol_table_in_file(int fd_out, Data_fusion *df, Symtab_Struct *st_out)
+static int write_new_symbol_table_in_file(Out_Image *img, Data_fusion *df, Symtab_Struct *st_out)
 {
-	int ind;
-	for(ind = 0; strcmp(df->f[ind]->section, ".symtab"); ind++);
-	off_t old_offset = df->f[ind]->offset;
-	off_t new_offset = old_offset;
-	lseek(fd_out, old_offset, SEEK_SET);
+	int ind, strind;
+	Elf32_Sym *tab;
 
-	for(int i = 0; i < st_out->nbSymbol; i++)
+	ind = find_merged_section(df, SHT_SYMTAB);
+	if(ind == -1)
 	{
-		print_debug("Écriture du symbole n°%2i '%s' dans le fichier à l'offset %#x ", i, get_symbol_name(st_out->tab, st_out->symbolNameTable, i), old_offset);
-		new_offset += write(fd_out, &st_out->tab[i]->st_name,  sizeof(st_out->tab[i]->st_name));
-		new_offset += write(fd_out, &st_out->tab[i]->st_value, sizeof(st_out->tab[i]->st_value));
-		new_offset += write(fd_out, &st_out->tab[i]->st_size,  sizeof(st_out->tab[i]->st_size));
-		new_offset += write(fd_out, &st_out->tab[i]->st_info,  sizeof(st_out->tab[i]->st_info));
-		new_offset += write(fd_out, &st_out->tab[i]->st_other, sizeof(st_out->tab[i]->st_other));
-		new_offset += write(fd_out, &st_out->tab[i]->st_shndx, sizeof(st_out->tab[i]->st_shndx));
-		print_debug("(%s)\n", (sizeof(Elf32_Sym) == new_offset - old_offset) ? "correct" : "ERREUR");
-		old_offset = new_offset;
+		fprintf(stderr, "FATAL : la fusion n'a pas de table des symboles !\n");
+		return 2;
+	}
+	strind = df->f[ind]->shdr->sh_link;
+	if(strind >= df->nb_sections)
+	{
+		fprintf(stderr, "FATAL : la table des symboles n'a pas de table des noms !\n");
+		return 2;
 	}
+
+	/* Certains assembleurs placent les noms de section dans la table des noms de symboles */
+	const int shared = (strind == df->in[0].newsec[ df->in[0].ehdr->e_shstrndx ]);
+	if(shared)
+		for(int i = 0; i < df->nb_sections; i++)
+			df->f[i]->shdr->sh_name = add_in_str_table(df->strtab, df->f[i]->section);
+
+	/* On fige la table des noms de symboles avant de connaître les indices définitifs */
+	finalize_str_table(df->strtab, 1);
+	for(int i = 0; i < st_out->nbSymbol; i++)
+		st_out->tab[i].st_name = get_str_table_offset(df->strtab, st_out->tab[i].st_name);
+	if(shared)
+		for(int i = 0; i < df->nb_sections; i++)
+			df->f[i]->shdr->sh_name = get_str_table_offset(df->strtab, df->f[i]->shdr->sh_name);
+	st_out->symbolNameTable = df->strtab->data;
+
+	if(trace_enabled(TRACE_IO, TRACE_DETAIL))
+		for(int i = 0; i < st_out->nbSymbol; i++)
+			trace_printf("Écriture du symbole n°%2i '%s' dans le fichier à l'offset %#x\n", i,
+				get_symbol_name(st_out->tab, st_out->symbolNameTable, i), df->f[ind]->offset + i * sizeof(Elf32_Sym));
+
+	/* La table est recopiée dans l'image, dans le boutisme du fichier de sortie */
+	tab = alloc_out_segment(img, df->f[ind]->offset, st_out->nbSymbol * sizeof(Elf32_Sym));
+	memcpy(tab, st_out->tab, st_out->nbSymbol * sizeof(Elf32_Sym));
+	if(df->dec.swap)
+		swap_elf32_sym_array(tab, st_out->nbSymbol);
 	df->f[ind]->shdr->sh_size = st_out->nbSymbol * sizeof(Elf32_Sym);
+	df->f[ind]->shdr->sh_info = df->first_global;
+
+	/* La table des noms reste allouée jusqu'à destroy_data_fusion, elle n'est pas recopiée */
+	TRACE(TRACE_IO, TRACE_DETAIL, "Écriture de la table des noms de symboles dans le fichier à l'offset %#x\n", df->f[strind]->offset);
+	add_out_segment(img, df->f[strind]->offset, df->strtab->data, df->strtab->size);
+	df->f[strind]->shdr->sh_size = df->strtab->size;
 
-	for(ind = 0; strcmp(df->f[ind]->section, ".strtab"); ind++);
-	print_debug("Écriture de la table des noms de symboles dans le fichier à l'offset %#x\n", df->f[ind]->offset);
-	lseek(fd_out, df->f[ind]->offset, SEEK_SET);
-	for(int i = 0; i < df->symbolNameTable_size; i += strlen(&(st_out->symbolNameTable[i])) + 1)
-		write(fd_out, &(st_out->symbolNameTable[i]), strlen(&(st_out->symbolNameTable[i])) + 1);
-	df->f[ind]->shdr->sh_size = df->symbolNameTable_size;
+	return 0;
 }
 
-static void write_new_relocation_table_in_file(int fd_out, Data_Rel *drel, unsigned index)
+static void write_new_relocation_table_in_file(Out_Image *img, const Elf_Decoder *dec, Rel_Section *s)
 {
-	print_debug("Écriture de la table de réimplémentations dans le fichier à l'offset %#x\n", drel->a_rel[index]);
-	lseek(fd_out, drel->a_rel[index], SEEK_SET);
-	for(int i = 0; i < drel->e_rel[index]; i++)
+	const void *entries = (s->rela != NULL) ? (const void *) s->rela : (const void *) s->rel;
+	const size_t size   = ((s->rela != NULL) ? sizeof(Elf32_Rela) : sizeof(Elf32_Rel)) * s->nb_entries;
+	void *tab;
+
+	TRACE(TRACE_IO, TRACE_DETAIL, "Écriture de la table de réimplémentations dans le fichier à l'offset %#x\n", s->offset);
+
+	/* Sans changement de boutisme, les entrées corrigées sont écrites telles quelles */
+	if(!dec->swap)
 	{
-		write(fd_out, &drel->rel[index][i]->r_offset, sizeof(drel->rel[index][i]->r_offset));
-		write(fd_out, &drel->rel[index][i]->r_info,   sizeof(drel->rel[index][i]->r_info));
+		add_out_segment(img, s->offset, entries, size);
+		return;
 	}
+	tab = alloc_out_segment(img, s->offset, size);
+	memcpy(tab, entries, size);
+	if(s->rela != NULL)
+		swap_elf32_rela_array(tab, s->nb_entries);
+	else
+		swap_elf32_rel_array(tab, s->nb_entries);
 }
 
 static void destroy_data_fusion(Data_fusion *df)
 {
-	for(int i = 0; i < df->nb_sections; i++)
-		free(df->f[i]->shdr);
-	for(int i = 0; i < df->nb_sections; i++)
-		free(df->f[i]);
-	free(df->f);
-	free(df->newsec1);
-	free(df->newsec2);
-	free(df);
+	Arena *arena = df->arena;
+
+	/* Toutes les structures lues ou construites sont dans les arènes */
+	for(int k = 0; k < df->nb_inputs; k++)
+	{
+		if(df->in[k].ef == NULL)
+			continue;
+		destroy_arena(df->in[k].ef->arena);
+		close_elf_file(df->in[k].ef);
+	}
+	if(df->strtab != NULL)
+		destroy_str_table(df->strtab);
+	if(df->section_index != NULL)
+		destroy_name_index(df->section_index);
+	destroy_arena(arena);
 }
@@ -2,12 +2,20 @@
 #define _FUSION_H_
 
 #include <elf.h>
+#include "elf_file.h"
 #include "section.h"
 #include "symbol.h"
 #include "relocation.h"
+#include "str_table.h"
+#include "name_index.h"
+#include "out_image.h"
+#include "arena.h"
+#include "stats.h"
 
+/* Genres de sections, dans l'ordre où ils sont placés dans le fichier de sortie */
 typedef enum
 {
+	NULLSEC,
 	PROGBITS,
 	REL,
 	ARM,
@@ -23,9 +31,42 @@ typedef struct
 
 typedef struct
 {
-	char section[32];
-	Elf32_Shdr *ptr_shdr1;
-	Elf32_Shdr *ptr_shdr2;
+	unsigned input; // Indice du fichier d'entrée
+	unsigned index; // Indice de la section dans ce fichier
+} Section_Ref;
+
+/* Valeur corrigée, écrite par-dessus le contenu d'une partie recopiée de fichier à fichier */
+typedef struct
+{
+	Elf32_Word offset;      // Adresse de décalage de la valeur dans la partie
+	unsigned size;          // Taille de la valeur (1, 2 ou 4)
+	unsigned char bytes[4]; // Valeur corrigée, dans le boutisme du fichier
+} Implicit_Patch;
+
+typedef struct
+{
+	unsigned input;   // Indice du fichier d'entrée
+	unsigned index;   // Indice de la section dans ce fichier
+	Elf32_Shdr *shdr; // En-tête de la section dans ce fichier
+	Elf32_Word shift; // Décalage de cette partie dans la section fusionnée
+	unsigned char *data; // Copie corrigée du contenu (NULL si la section est recopiée telle quelle)
+	Implicit_Patch *patches; // Valeurs corrigées, tant que la partie est recopiée telle quelle
+	unsigned nb_patches;
+} Fusion_Part;
+
+/* Champ d'une instruction ou d'une donnée qui contient la valeur implicite d'une réimplantation REL */
+typedef struct
+{
+	unsigned size;     // Taille du champ en octets (1, 2 ou 4)
+	Elf32_Word mask;   // Bits occupés par la valeur dans le champ
+	unsigned rshift;   // Nombre de bits de poids faible non stockés (instructions de branchement)
+} Implicit_Field;
+
+typedef struct
+{
+	const char *section; // Nom de la section, dans la table des noms du fichier d'où elle vient (non copié)
+	unsigned nb_parts;
+	Fusion_Part *parts; // Contributions des fichiers d'entrée, dans l'ordre des fichiers
 	Elf32_Word size;
 	Elf32_Off offset;
 	Elf32_Shdr *shdr;
@@ -33,190 +74,296 @@ typedef struct
 
 typedef struct
 {
+	const char *filename;
+	Elf_File *ef;
+	Elf32_Ehdr *ehdr;
+	Section_Table *secTab;
+	symbolTable *st;
+	Data_Rel *drel;
+	Elf32_Section *newsec; // Nouvel indice de chaque section du fichier
+	Elf32_Word *shift;     // Décalage de chaque section du fichier dans sa section fusionnée
+	Elf32_Word *newsym;    // Nouvel indice de chaque symbole du fichier dans la table fusionnée
+} Input_File;
+
+typedef struct
+{
+	unsigned nb_inputs;
+	Input_File *in;
 	unsigned nb_sections;
 	Elf32_Off offset;
-	unsigned nb_written;
-	off_t file_offset;
-	char *sectionNameTable;
 	Range range[TYPES_COUNT];
-	Elf32_Word sectionNameTable_size, symbolNameTable_size;
-	Elf32_Section *newsec1, *newsec2;
+	Str_Table *strtab;
+	Name_Index *section_index; // Indice de chaque section fusionnée, par nom
 	Fusion **f;
+	Elf_Decoder dec; // Boutisme du fichier de sortie, qui est celui des fichiers d'entrée
+	Arena *arena;    // Arène de la fusion (chaque fichier d'entrée a aussi la sienne, dans son Elf_File)
+	Stats stats;     // Mesures de chaque étape (--stats)
+	Elf32_Word *sorted_index; // Indice de chaque symbole de la table fusionnée après le tri
+	Elf32_Word first_global;  // Indice du premier symbole non local après le tri
+	unsigned long nb_syscalls; // Appels système faits directement par la fusion (ouverture de la sortie)
 } Data_fusion;
 
-typedef enum { ONLY1, MERGE, MERGE_NOT_IN } Gather_Mode;
+typedef enum { ONLY1, MERGE } Gather_Mode;
 
 /**
- * Ouvre les deux premiers fichiers passés en argument en lecture
- * et le troisième en écriture
+ * Ouvre et projette en mémoire les fichiers d'entrée passés en argument
+ * et ouvre le premier fichier en écriture
  *
+ * @param argc:   le nombre d'arguments
  * @param argv:   la ligne des arguments
- * @param fd_in1: premier fichier en entrée
- * @param fd_in2: second fichier en entrée
+ * @param df:     une structure de type Data_fusion dont les fichiers d'entrée sont alloués
  * @param fd_out: fichier de sortie
  * @retourne 0 en cas de succès
  **/
-static int open_files(char *argv[], int *fd_in1, int *fd_in2, int *fd_out);
+static int open_files(int argc, char *argv[], Data_fusion *df, int *fd_out);
 
 /**
- * Rassemble les sections des types passés en paramètre
+ * Lis l'en-tête, la table des sections, les tables des symboles et les tables de réimplantations
+ * d'un fichier d'entrée ; peut être exécutée en parallèle pour des fichiers différents
  *
- * @param df:       une structure de type Data_fusion
- * @param secTab1:  une structure de type Section_Table initialisée concernant le premier fichier
- * @param secTab2:  une structure de type Section_Table initialisée concernant le second fichier
- * @parem type:     le genre de type de sections de type Sections_Type
- * @param nb_types: le nombre de types à passer en argument
- * @param mode:     le mode, de type Gather_Mode
- * @param ...:      les types de section à placer dans df
+ * @param arg: un fichier d'entrée ouvert, de type Input_File
  **/
-static void gather_sections(Data_fusion *df, Section_Table *secTab1, Section_Table *secTab2, Sections_Type type, Gather_Mode mode, int nb_types, ...);
+static void load_input_file(void *arg);
 
 /**
- * Calcule les tables de correspondance des numéros de sections d'un fichier d'entrée avec
- * les numéros de section du fichier de sortie
+ * Retire l'option --stats (ou --stats=table, --stats=json) des arguments
  *
- * @param df:     une structure de type Data_fusion
- * @param secTab1: une structure de type Section_Table initialisée correspondant au premier fichier
- * @param secTab2: une structure de type Section_Table initialisée correspondant au second fichier
+ * @param argc: le nombre d'arguments, mis à jour
+ * @param argv: la ligne des arguments, mise à jour
+ * @retourne le format des mesures (STATS_OFF sans l'option), ou -1 si le format est inconnu
  **/
-void find_new_section_index(Data_fusion *df, Section_Table *secTab1, Section_Table *secTab2);
+static int parse_stats_option(int *argc, char *argv[]);
 
 /**
- * Met à jour les indices de section d'une section
+ * Termine la mesure d'une étape de la fusion (sans effet si les mesures ne sont pas actives) :
+ * relève les compteurs d'entrées-sorties et d'allocations, puis recommence la mesure du pic
+ * de mémoire des arènes pour l'étape suivante
+ *
+ * @param df:    une structure de type Data_fusion
+ * @param img:   l'image du fichier de sortie, ou NULL si elle n'est pas encore créée
+ * @param name:  le nom de l'étape qui vient de se terminer
+ * @param unit:  la nature des éléments traités par l'étape
+ * @param items: le nombre d'éléments traités
+ **/
+static void end_phase(Data_fusion *df, Out_Image *img, const char *name, const char *unit, unsigned long items);
+
+/**
+ * Compte les réimplantations de tous les fichiers d'entrée
+ *
+ * @param df: une structure de type Data_fusion dont les fichiers d'entrée sont chargés
+ * @retourne le nombre de réimplantations
+ **/
+static unsigned long count_relocations(Data_fusion *df);
+
+/**
+ * Vérifie que tous les fichiers d'entrée ont pu être lus et peuvent être fusionnés ensemble
+ *
+ * @param df: une structure de type Data_fusion dont les fichiers d'entrée sont chargés
+ * @retourne 0 si les fichiers sont compatibles
+ **/
+static int check_input_files(Data_fusion *df);
+
+/**
+ * Retourne le genre d'un type de section, d'après la table section_classes
+ *
+ * @param sh_type: le type de la section
+ * @retourne le genre de la section, de type Sections_Type (SKIP si le type n'est pas dans la table)
+ **/
+static Sections_Type classify_section(Elf32_Word sh_type);
+
+/**
+ * Rassemble les sections de tous les fichiers d'entrée : un premier parcours les range par genre,
+ * puis chaque genre est fusionné à son tour et occupe un bloc (Range) de la nouvelle table
  *
  * @param df: une structure de type Data_fusion
  **/
-static void update_section_index_in_sections(Data_fusion *df);
+static void gather_sections(Data_fusion *df);
+
+/**
+ * Calcule l'adresse de décalage de chaque section du fichier de sortie, ainsi que
+ * le décalage de chaque partie à l'intérieur des sections fusionnées
+ *
+ * @param df: une structure de type Data_fusion dont les sections sont rassemblées
+ **/
+static void layout_sections(Data_fusion *df);
 
 /**
- * Met à jour l'indices de section d'un symbole
+ * Calcule les tables de correspondance des numéros de sections de chaque fichier d'entrée avec
+ * les numéros de section du fichier de sortie
  *
- * @param symbol:      un symbole de type Elf32_Sym à corriger
- * @param newsec:      un tableau de type Elf32_Section contenant les nouveaux index de sections
- * @param nb_sections: le nombre de sections dans le fichier de sortie
+ * @param df: une structure de type Data_fusion
  **/
-static void update_section_index_in_symbol(Elf32_Sym *symbol, Elf32_Section *newsec, unsigned nb_sections);
+void find_new_section_index(Data_fusion *df);
 
 /**
- * Calcule l'indice d'une sous-chaîne dans une chaîne
+ * Met à jour les indices de section d'une section
  *
- * @param haystack: la chaîne dans laquelle rechercher la sous-chaîne
- * @param needle:   la sous-chaîne
- * @param size:     la taille de haystack
- * @retourne l'indice une valeur >= 0 en cas de succès, -1 sinon
+ * @param df: une structure de type Data_fusion
  **/
-static int find_index_in_name_table(char *haystack, char *needle, Elf32_Word size);
+static void update_section_index_in_sections(Data_fusion *df);
 
 /**
- * Ajoute un symbole à la table des symboles
+ * Met à jour l'indice de section et la valeur d'un symbole
  *
- * @param st:     une structure de type symbolTable
- * @param symtab: un symbole de type Elf32_Sym initialisé
- * @retourne l'indice où le nouveau symbole a été ajouté
+ * @param symbol: un symbole de type Elf32_Sym à corriger
+ * @param in:     le fichier d'entrée d'où provient le symbole
  **/
-static int add_symbol_in_table(Symtab_Struct *st, Elf32_Sym *symtab);
+static void update_section_index_in_symbol(Elf32_Sym *symbol, Input_File *in);
 
 /**
- * Fusionne deux tables des symboles tout en les corrigeant
+ * Fusionne les tables des symboles de tous les fichiers d'entrée dans celle du premier,
+ * tout en les corrigeant ; retient le nouvel indice de chaque symbole d'entrée (newsym)
  *
  * @param df:      une structure de type Data_fusion initialisée
- * @param secTab1: une structure de type Section_Table initialisée correspondant au premier fichier
- * @param secTab2: une structure de type Section_Table initialisée correspondant au second fichier
- * @param st1:     une structure de type symbolTable initialisée correspondant au premier fichier
- * @param st2:     une structure de type symbolTable initialisée correspondant au second fichier
  * @param st_out:  une structure de type symbolTable initialisée correspondant au fichier à créer
  * @retourne 0 en cas de succès
  **/
-static int merge_and_fix_symbols(Data_fusion *df, Section_Table *secTab1, Section_Table *secTab2, symbolTable *st1, symbolTable *st2, Symtab_Struct *st_out);
+static int merge_and_fix_symbols(Data_fusion *df, Symtab_Struct *st_out);
 
 /**
- * Met à jour le champ r_info des tables de réimplantations
+ * Renumérote les symboles d'une table de réimplantations d'après la table de correspondance
+ * du fichier d'entrée, et décale leurs adresses
  *
- * @param df:     une structure de type Data_fusion initialisée
- * @param drel1:  une structure de type Data_Rel initialisée correspondant premier fichier
- * @param drel2:  une structure de type Data_Rel initialisée correspondant second fichier
- * @param st1:     une structure de type symbolTable initialisée correspondant au premier fichier
- * @param st2:     une structure de type symbolTable initialisée correspondant au second fichier
+ * @param rel:        les réimplantations à corriger, contiguës
+ * @param nb_entries: le nombre de réimplantations
+ * @param in:         le fichier d'entrée d'où proviennent les réimplantations
+ * @param shift:      le décalage de la section cible dans sa section fusionnée
  **/
-static void update_relocations_info(Data_fusion *df, Data_Rel *drel1, Data_Rel *drel2, symbolTable *st1, symbolTable *st2);
+static void update_relocations_info(Elf32_Rel *rel, unsigned nb_entries, const Input_File *in, Elf32_Word shift);
 
 /**
- * Fusionne deux tables de réimplantations tout en corrigeant les symboles
+ * Comme update_relocations_info pour une table SHT_RELA ; la valeur ajoutée des réimplantations
+ * portant sur un symbole de section est aussi décalée comme la section de ce symbole
  *
- * @param df:      une structure de type Data_fusion initialisée
- * @param fd2:     le descripteur de fichier du second fichier
- * @param fd_out:  le descripteur de fichier du fichier de sortie
- * @param secTab1: une structure de type Section_Table initialisée correspondant au premier fichier
- * @param secTab2: une structure de type Section_Table initialisée correspondant au second fichier
- * @param drel1:   une structure de type Data_Rel initialisée  correspondant au premier fichier
- * @param drel1:   une structure de type Data_Rel initialisée  correspondant au second fichier
+ * @param rela:       les réimplantations à corriger, contiguës
+ * @param nb_entries: le nombre de réimplantations
+ * @param in:         le fichier d'entrée d'où proviennent les réimplantations
+ * @param shift:      le décalage de la section cible dans sa section fusionnée
  **/
-static void merge_and_fix_relocations(Data_fusion *df, int fd2, int fd_out, Section_Table *secTab1, Section_Table *secTab2, Data_Rel *drel1, Data_Rel *drel2);
+static void update_relocations_info_rela(Elf32_Rela *rela, unsigned nb_entries, const Input_File *in, Elf32_Word shift);
 
 /**
- * Trie une table des symboles
+ * Décrit le champ qui contient la valeur implicite d'une réimplantation
  *
- * @param st: une structure de type symbolTable
+ * @param machine: la machine des fichiers d'entrée (e_machine)
+ * @param type:    le type de la réimplantation
+ * @param field:   le champ décrit
+ * @retourne 0 si le type n'est pas pris en charge pour cette machine
  **/
-static void sort_new_symbol_table(Symtab_Struct *st);
+static int get_implicit_addend_field(Elf32_Half machine, Elf32_Word type, Implicit_Field *field);
 
 /**
- * Écrit le nouvel en-tête ELF dans le fichier de sortie
+ * Corrige la valeur implicite d'une réimplantation portant sur un symbole de section,
+ * quand la section du symbole a été décalée par la fusion. La valeur corrigée est retenue
+ * comme correctif de la partie ; au-delà de MAX_PART_PATCHES correctifs, la correction est
+ * faite dans une copie du contenu de la partie
  *
- * @param fd_out: fichier de sortie
- * @param ehdr:   une structure de type Elf32_Ehdr initialisée
- * @param df:     une structure de type Data_fusion initialisée
+ * @param arena:    l'arène où allouer la copie
+ * @param part:     la partie de section sur laquelle porte la réimplantation
+ * @param in:       le fichier d'entrée d'où provient la réimplantation
+ * @param r_offset: l'adresse de décalage de la valeur dans la partie
+ * @param type:     le type de la réimplantation
+ * @param shift:    le décalage de la section du symbole
  **/
-static void write_elf_header_in_file(int fd_out, Elf32_Ehdr *ehdr, Data_fusion *df);
+static void fix_implicit_addend(Arena *arena, Fusion_Part *part, Input_File *in, Elf32_Word r_offset, Elf32_Word type, Elf32_Word shift);
 
 /**
- * Écrit des sections dans le fichier de sortie en fonction de leur type
+ * Recherche la partie de section fusionnée qui provient d'une section d'un fichier d'entrée
  *
- * @param df:     une structure de type Data_fusion initialisée
- * @param fd_in1: premier fichier en entrée
- * @param fd_in2: second fichier en entrée
- * @param fd_out: fichier de sortie
- * @parem type:   le genre de type de sections de type Sections_Type
+ * @param df:    une structure de type Data_fusion initialisée
+ * @param input: l'indice du fichier d'entrée
+ * @param index: l'indice de la section dans ce fichier
+ * @retourne un pointeur sur la partie, ou NULL si la section n'a pas été retenue
  **/
-static void write_given_sections_in_file(Data_fusion *df, int fd1, int fd2, int fd_out, Sections_Type type);
+static Fusion_Part *find_part(Data_fusion *df, unsigned input, unsigned index);
 
 /**
- * Recopie une section depuis un fichier vers un autre fichier
+ * Fusionne les tables de réimplantations (REL et RELA) de tous les fichiers d'entrée et les place
+ * dans l'image, en corrigeant les adresses de décalage et les valeurs ajoutées des sections fusionnées
  *
- * PRÉ-CONDITION: le curseur de fd_out est placé au bon endroit
- * @param fd_in:  un descrpteur de fichier vers le fichier d'entrée
- * @param fd_out: un descrpteur de fichier vers le fichier de sortie
- * @param shdr:   une structure de type Elf32_Shdr initialisée
- * @retourne le nombre d'octets écrits dans le fichier
+ * PRÉ-CONDITION: le contenu des sections n'a pas encore été placé dans l'image
+ * @param df:  une structure de type Data_fusion initialisée
+ * @param img: l'image du fichier de sortie
  **/
-static ssize_t write_section_in_file(int fd_in, int fd_out, Elf32_Shdr *shdr);
+static void merge_and_fix_relocations(Data_fusion *df, Out_Image *img);
 
 /**
- * Écrit la nouvelle table des noms de section dans le fichier de sortie
+ * Trie la table des symboles fusionnée, en temps linéaire et sans changer l'ordre relatif des
+ * symboles d'une même classe : symboles de section, autres symboles locaux, puis symboles non
+ * locaux. Retient dans df le nouvel indice de chaque symbole et l'indice du premier non local,
+ * et met à jour les tables de correspondance des fichiers d'entrée
  *
- * @param fd_out: fichier de sortie
- * @param ehdr:   une structure de type Elf32_Ehdr initialisée
- * @param df:     une structure de type Data_fusion initialisée
+ * @param df: une structure de type Data_fusion initialisée
+ * @param st: la table des symboles fusionnée
  **/
-static void write_new_section_table_in_file(int fd_out, Elf32_Ehdr *ehdr, Data_fusion *df);
+static void sort_new_symbol_table(Data_fusion *df, Symtab_Struct *st);
 
 /**
- * Écrit la table des symboles dans le fichier de sortie
+ * Place le nouvel en-tête ELF dans l'image du fichier de sortie
  *
- * @param fd_out: fichier de sortie
+ * @param img:  l'image du fichier de sortie
+ * @param ehdr: une structure de type Elf32_Ehdr initialisée
+ * @param df:   une structure de type Data_fusion initialisée
+ **/
+static void write_elf_header_in_file(Out_Image *img, Elf32_Ehdr *ehdr, Data_fusion *df);
+
+/**
+ * Place des sections dans l'image du fichier de sortie en fonction de leur type
+ *
+ * @param df:   une structure de type Data_fusion initialisée
+ * @param img:  l'image du fichier de sortie
+ * @parem type: le genre de type de sections de type Sections_Type
+ **/
+static void write_given_sections_in_file(Data_fusion *df, Out_Image *img, Sections_Type type);
+
+/**
+ * Place le contenu d'une partie de section dans l'image du fichier de sortie, sans le recopier :
+ * il est pris directement dans le fichier d'entrée, ou dans la copie corrigée de la partie
+ *
+ * @param img:    l'image du fichier de sortie
+ * @param ef_in:  la projection du fichier d'entrée
+ * @param part:   une structure de type Fusion_Part initialisée
+ * @param offset: l'adresse de décalage de la partie dans le fichier de sortie
+ **/
+static void add_section_in_image(Out_Image *img, Elf_File *ef_in, Fusion_Part *part, Elf32_Off offset);
+
+/**
+ * Cherche la première section fusionnée d'un type donné
+ *
+ * @param df:   une structure de type Data_fusion dont les sections sont rassemblées
+ * @param type: le type de section cherché (SHT_SYMTAB...)
+ * @retourne l'indice de la section dans la table fusionnée, ou -1 si aucune n'a ce type
+ **/
+static int find_merged_section(Data_fusion *df, Elf32_Word type);
+
+/**
+ * Place la nouvelle table des noms de section et la table des en-têtes de section
+ * dans l'image du fichier de sortie
+ *
+ * @param img:  l'image du fichier de sortie
+ * @param ehdr: une structure de type Elf32_Ehdr initialisée
+ * @param df:   une structure de type Data_fusion initialisée
+ **/
+static void write_new_section_table_in_file(Out_Image *img, Elf32_Ehdr *ehdr, Data_fusion *df);
+
+/**
+ * Place la table des symboles et la table des noms de symboles dans l'image du fichier de sortie
+ *
+ * @param img:    l'image du fichier de sortie
  * @param df:     une structure de type Data_fusion initialisée
  * @param st_out: une structure de type Symtab_Struct initialisée
+ * @retourne 0, ou 2 si la fusion n'a pas de table des symboles utilisable
  **/
-static void write_new_symbol_table_in_file(int fd_out, Data_fusion *df, Symtab_Struct *st_out);
+static int write_new_symbol_table_in_file(Out_Image *img, Data_fusion *df, Symtab_Struct *st_out);
 
 /**
- * Écrit une table de réimplantations dans le fichier de sortie
+ * Place une table de réimplantations dans l'image du fichier de sortie
  *
- * @param fd_out: fichier de sortie
- * @param drel:   une structure de type Data_Rel initialisée
- * @parem index:  l'indice de la table
+ * @param img:    l'image du fichier de sortie
+ * @param dec:    le décodeur donnant le boutisme du fichier de sortie
+ * @param s:      le descripteur de la table, dont les entrées sont corrigées
  **/
-static void write_new_relocation_table_in_file(int fd_out, Data_Rel *drel, unsigned index);
+static void write_new_relocation_table_in_file(Out_Image *img, const Elf_Decoder *dec, Rel_Section *s);
 
 /**
  * Libère la mémoire allouée pour une structure de type Data_fusion
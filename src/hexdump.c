@@ -0,0 +1,178 @@
+#include <string.h>
+#include <stdint.h>
+#include <elf.h>
+
+#include "hexdump.h"
+
+/* Les noyaux vectoriels sont écrits pour cette disposition des lignes */
+#if (BYTES_COUNT != 16) || (BLOCKS_COUNT != 4)
+#error "hexdump.c suppose des lignes de 16 octets en 4 blocs"
+#endif
+
+/* Positions dans une ligne : chiffres de chaque bloc, puis colonne ASCII */
+#define HEX_COLUMN(block) (13 + (block) * (2 * BYTES_PER_BLOCK + 1))
+#define ASCII_COLUMN      (HEXDUMP_LINE - BYTES_COUNT - 1)
+
+/* Nombre de lignes réservées à la fois dans le tampon */
+#define LINES_PER_CHUNK 1024
+
+static const char hex_digits[16] = "0123456789abcdef";
+
+/* Convertit n lignes complètes à partir de data et retourne le nombre de lignes écrites */
+typedef size_t (*Hexdump_Kernel)(char *dst, const unsigned char *data, size_t n);
+
+/* Écrit tout ce qui ne dépend pas du contenu : l'adresse, les séparateurs et le saut de ligne */
+static void write_line_frame(char *p, Elf32_Word addr)
+{
+	memcpy(p, "  0x", 4);
+	for(int d = 0; d < 8; d++)
+		p[4 + d] = hex_digits[(addr >> (28 - 4 * d)) & 0xf];
+	p[12] = ' ';
+	for(int b = 0; b < BLOCKS_COUNT; b++)
+		p[HEX_COLUMN(b) + 2 * BYTES_PER_BLOCK] = ' ';
+	p[HEXDUMP_LINE - 1] = '\n';
+}
+
+/* Convertit une ligne de n octets (n <= BYTES_COUNT) ; la fin d'une ligne incomplète est remplie d'espaces */
+static void write_line_scalar(char *p, const unsigned char *data, unsigned n)
+{
+	for(unsigned k = 0; k < BYTES_COUNT; k++)
+	{
+		char *h = p + HEX_COLUMN(k / BYTES_PER_BLOCK) + 2 * (k % BYTES_PER_BLOCK);
+
+		if(k < n)
+		{
+			h[0] = hex_digits[data[k] >> 4];
+			h[1] = hex_digits[data[k] & 0xf];
+			p[ASCII_COLUMN + k] = ((data[k] >= 0x20) && (data[k] < 0x7f)) ? data[k] : '.';
+		}
+		else
+		{
+			h[0] = h[1] = ' ';
+			p[ASCII_COLUMN + k] = ' ';
+		}
+	}
+}
+
+static size_t hexdump_scalar(char *dst, const unsigned char *data, size_t n)
+{
+	for(size_t i = 0; i < n; i++)
+		write_line_scalar(dst + i * HEXDUMP_LINE, data + i * BYTES_COUNT, BYTES_COUNT);
+	return n;
+}
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+
+/* Le caractère d'un quartet : '0' + q, plus 'a' - '0' - 10 au-delà de 9 */
+__attribute__((target("sse2")))
+static inline __m128i nibbles_to_hex_sse2(__m128i q)
+{
+	__m128i letters = _mm_and_si128(_mm_cmpgt_epi8(q, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+	return _mm_add_epi8(_mm_add_epi8(q, _mm_set1_epi8('0')), letters);
+}
+
+/* Caractères imprimables : 0x20 <= c < 0x7f, soit c > 0x1f en signé (les octets >= 0x80 sont négatifs) et c != 0x7f */
+__attribute__((target("sse2")))
+static inline __m128i printable_sse2(__m128i v)
+{
+	__m128i m = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(0x7f)), _mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)));
+	return _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, _mm_set1_epi8('.')));
+}
+
+/* Place les chiffres de 16 octets : lo contient ceux des octets 0 à 7, hi ceux des octets 8 à 15 */
+__attribute__((target("sse2")))
+static inline void store_hex_sse2(char *p, __m128i lo, __m128i hi)
+{
+	_mm_storel_epi64((__m128i *) (p + HEX_COLUMN(0)), lo);
+	_mm_storel_epi64((__m128i *) (p + HEX_COLUMN(1)), _mm_unpackhi_epi64(lo, lo));
+	_mm_storel_epi64((__m128i *) (p + HEX_COLUMN(2)), hi);
+	_mm_storel_epi64((__m128i *) (p + HEX_COLUMN(3)), _mm_unpackhi_epi64(hi, hi));
+}
+
+__attribute__((target("sse2")))
+static size_t hexdump_sse2(char *dst, const unsigned char *data, size_t n)
+{
+	const __m128i low_nibble = _mm_set1_epi8(0x0f);
+
+	for(size_t i = 0; i < n; i++, dst += HEXDUMP_LINE, data += BYTES_COUNT)
+	{
+		__m128i v  = _mm_loadu_si128((const __m128i *) data);
+		__m128i hi = nibbles_to_hex_sse2(_mm_and_si128(_mm_srli_epi16(v, 4), low_nibble));
+		__m128i lo = nibbles_to_hex_sse2(_mm_and_si128(v, low_nibble));
+
+		/* Entrelace quartet fort et quartet faible de chaque octet */
+		store_hex_sse2(dst, _mm_unpacklo_epi8(hi, lo), _mm_unpackhi_epi8(hi, lo));
+		_mm_storeu_si128((__m128i *) (dst + ASCII_COLUMN), printable_sse2(v));
+	}
+	return n;
+}
+
+/* Deux lignes à la fois : chaque moitié de registre traite une ligne */
+__attribute__((target("avx2")))
+static size_t hexdump_avx2(char *dst, const unsigned char *data, size_t n)
+{
+	const __m256i low_nibble = _mm256_set1_epi8(0x0f);
+	const __m256i table      = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) hex_digits));
+	size_t i;
+
+	for(i = 0; i + 2 <= n; i += 2, dst += 2 * HEXDUMP_LINE, data += 2 * BYTES_COUNT)
+	{
+		__m256i v  = _mm256_loadu_si256((const __m256i *) data);
+		__m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibble));
+		__m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low_nibble));
+		__m256i first  = _mm256_unpacklo_epi8(hi, lo);
+		__m256i second = _mm256_unpackhi_epi8(hi, lo);
+		__m256i m = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7f)),
+		                                _mm256_cmpgt_epi8(v, _mm256_set1_epi8(0x1f)));
+		__m256i ascii = _mm256_blendv_epi8(_mm256_set1_epi8('.'), v, m);
+
+		store_hex_sse2(dst, _mm256_castsi256_si128(first), _mm256_castsi256_si128(second));
+		store_hex_sse2(dst + HEXDUMP_LINE, _mm256_extracti128_si256(first, 1), _mm256_extracti128_si256(second, 1));
+		_mm_storeu_si128((__m128i *) (dst + ASCII_COLUMN), _mm256_castsi256_si128(ascii));
+		_mm_storeu_si128((__m128i *) (dst + HEXDUMP_LINE + ASCII_COLUMN), _mm256_extracti128_si256(ascii, 1));
+	}
+	return i + hexdump_sse2(dst, data, n - i);
+}
+
+/* Le jeu d'instructions est choisi à l'exécution */
+static Hexdump_Kernel select_kernel(void)
+{
+	if(__builtin_cpu_supports("avx2"))
+		return hexdump_avx2;
+	if(__builtin_cpu_supports("sse2"))
+		return hexdump_sse2;
+	return hexdump_scalar;
+}
+#else
+static Hexdump_Kernel select_kernel(void)
+{
+	return hexdump_scalar;
+}
+#endif
+
+void hexdump_to_text_buffer(Text_Buffer *out, const unsigned char *data, Elf32_Word size, Elf32_Word addr)
+{
+	Hexdump_Kernel kernel = select_kernel();
+	size_t nb_lines = size / BYTES_COUNT;
+
+	for(size_t i = 0; i < nb_lines; i += LINES_PER_CHUNK)
+	{
+		size_t n = (nb_lines - i < LINES_PER_CHUNK) ? nb_lines - i : LINES_PER_CHUNK;
+		char *p = reserve_text_buffer(out, n * HEXDUMP_LINE);
+
+		for(size_t l = 0; l < n; l++)
+			write_line_frame(p + l * HEXDUMP_LINE, addr + (i + l) * BYTES_COUNT);
+		kernel(p, data + i * BYTES_COUNT, n);
+		out->size += n * HEXDUMP_LINE;
+	}
+
+	if(size % BYTES_COUNT)
+	{
+		char *p = reserve_text_buffer(out, HEXDUMP_LINE);
+
+		write_line_frame(p, addr + nb_lines * BYTES_COUNT);
+		write_line_scalar(p, data + nb_lines * BYTES_COUNT, size % BYTES_COUNT);
+		out->size += HEXDUMP_LINE;
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef _HEXDUMP_H_
+#define _HEXDUMP_H_
+
+#include <elf.h>
+#include "section.h"
+#include "text_buffer.h"
+
+/* Une ligne complète : "  0x" + adresse + " " + BLOCKS_COUNT blocs + " " chacun + ASCII + "\n" */
+#define HEXDUMP_LINE (4 + 8 + 1 + BLOCKS_COUNT * (2 * BYTES_PER_BLOCK + 1) + BYTES_COUNT + 1)
+
+/**
+ * Ajoute l'affichage hexadécimal d'une zone à un tampon, BYTES_COUNT octets par ligne.
+ * Les lignes complètes sont converties par blocs de 16 octets (AVX2 ou SSE2 quand le
+ * processeur le permet), puis écrites directement dans le tampon
+ *
+ * @param out:  un tampon initialisé
+ * @param data: la zone à afficher
+ * @param size: la taille de la zone
+ * @param addr: l'adresse du premier octet, affichée en tête de la première ligne
+ **/
+void hexdump_to_text_buffer(Text_Buffer *out, const unsigned char *data, Elf32_Word size, Elf32_Word addr);
+
+
+#endif
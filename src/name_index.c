@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "name_index.h"
+
+uint32_t hash_name(const char *name, unsigned *len)
+{
+	uint32_t h = 2166136261u;
+	const unsigned char *p = (const unsigned char *) name;
+
+	for(; *p != '\0'; p++)
+		h = (h ^ *p) * 16777619u;
+	*len = p - (const unsigned char *) name;
+
+	return h;
+}
+
+Name_Index *create_name_index(unsigned expected)
+{
+	unsigned size = 16;
+	Name_Index *ni = malloc(sizeof(Name_Index));
+
+	/* On garde un taux de remplissage inférieur à 1/2 */
+	while(size < 2 * expected)
+		size <<= 1;
+
+	ni->nb_entries = 0;
+	ni->mask       = size - 1;
+	ni->entries    = calloc(size, sizeof(Name_Entry));
+
+	return ni;
+}
+
+static Name_Entry *lookup_slot(Name_Index *ni, const char *name, uint32_t hash, unsigned len)
+{
+	unsigned i = hash & ni->mask;
+
+	while((ni->entries[i].name != NULL) &&
+	      ((ni->entries[i].hash != hash) || (ni->entries[i].len != len) || memcmp(ni->entries[i].name, name, len)))
+		i = (i + 1) & ni->mask;
+
+	return &ni->entries[i];
+}
+
+static void grow_name_index(Name_Index *ni)
+{
+	unsigned old_size = ni->mask + 1;
+	Name_Entry *old = ni->entries;
+
+	ni->mask    = 2 * old_size - 1;
+	ni->entries = calloc(2 * old_size, sizeof(Name_Entry));
+	for(unsigned i = 0; i < old_size; i++)
+		if(old[i].name != NULL)
+			*lookup_slot(ni, old[i].name, old[i].hash, old[i].len) = old[i];
+	free(old);
+}
+
+int find_in_name_index(Name_Index *ni, const char *name)
+{
+	unsigned len;
+	uint32_t hash = hash_name(name, &len);
+	Name_Entry *e = lookup_slot(ni, name, hash, len);
+
+	return (e->name != NULL) ? (int) e->value : -1;
+}
+
+unsigned add_in_name_index(Name_Index *ni, const char *name, unsigned value)
+{
+	unsigned len;
+	uint32_t hash = hash_name(name, &len);
+	Name_Entry *e = lookup_slot(ni, name, hash, len);
+
+	if(e->name != NULL)
+		return e->value;
+
+	e->name  = name;
+	e->hash  = hash;
+	e->len   = len;
+	e->value = value;
+	if(2 * ++ni->nb_entries > ni->mask)
+		grow_name_index(ni);
+
+	return value;
+}
+
+void destroy_name_index(Name_Index *ni)
+{
+	free(ni->entries);
+	free(ni);
+}
@@ -0,0 +1,65 @@
+#ifndef _NAME_INDEX_H_
+#define _NAME_INDEX_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+	const char *name; // Nom indexé (non copié, doit rester valide)
+	uint32_t hash;    // Empreinte du nom
+	unsigned len;     // Longueur du nom
+	unsigned value;   // Valeur associée au nom
+} Name_Entry;
+
+typedef struct
+{
+	unsigned nb_entries; // Nombre de noms indexés
+	unsigned mask;       // Nombre de cases - 1 (puissance de 2)
+	Name_Entry *entries; // Table à adressage ouvert (name == NULL si la case est libre)
+} Name_Index;
+
+/**
+ * Calcule l'empreinte d'un nom (FNV-1a) ainsi que sa longueur
+ *
+ * @param name: une chaîne de caractères
+ * @param len:  reçoit la longueur de la chaîne
+ * @retourne l'empreinte du nom
+ **/
+uint32_t hash_name(const char *name, unsigned *len);
+
+/**
+ * Crée un index de noms vide
+ *
+ * @param expected: le nombre de noms attendus (l'index s'agrandit au besoin)
+ * @retourne un pointeur sur une structure de type Name_Index
+ **/
+Name_Index *create_name_index(unsigned expected);
+
+/**
+ * Recherche un nom dans l'index
+ *
+ * @param ni:   une structure de type Name_Index initialisée
+ * @param name: le nom recherché
+ * @retourne la valeur associée au nom, ou -1 s'il n'est pas indexé
+ **/
+int find_in_name_index(Name_Index *ni, const char *name);
+
+/**
+ * Ajoute un nom dans l'index, s'il n'y est pas déjà
+ *
+ * @param ni:    une structure de type Name_Index initialisée
+ * @param name:  le nom à indexer, qui n'est pas copié
+ * @param value: la valeur à associer au nom
+ * @retourne la valeur associée au nom après l'ajout (l'ancienne si le nom était déjà indexé)
+ **/
+unsigned add_in_name_index(Name_Index *ni, const char *name, unsigned value);
+
+/**
+ * Libère la mémoire occupée par une structure Name_Index
+ *
+ * @param ni: une structure de type Name_Index initialisée
+ **/
+void destroy_name_index(Name_Index *ni);
+
+
+#endif
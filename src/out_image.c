@@ -0,0 +1,287 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <elf.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include "out_image.h"
+#include "util.h"
+#include "trace.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/* Les trous entre les segments sont écrits à partir de ce bloc de zéros */
+static const unsigned char zeros[4096];
+
+/* Taille des blocs de la recopie de secours */
+#define COPY_CHUNK (64 * 1024)
+
+Out_Image *create_out_image(unsigned expected)
+{
+	Out_Image *img = malloc(sizeof(Out_Image));
+
+	img->capacity         = (expected > 16) ? expected : 16;
+	img->segments         = malloc(sizeof(Out_Segment) * img->capacity);
+	img->nb_segments      = 0;
+	img->patches_capacity = 16;
+	img->patches          = malloc(sizeof(Out_Segment) * img->patches_capacity);
+	img->nb_patches       = 0;
+	img->owned_capacity   = 16;
+	img->owned            = malloc(sizeof(void*) * img->owned_capacity);
+	img->nb_owned         = 0;
+	img->nb_syscalls      = 0;
+	img->bytes_read       = 0;
+	img->bytes_written    = 0;
+
+	return img;
+}
+
+void add_out_segment(Out_Image *img, Elf32_Off offset, const void *data, size_t size)
+{
+	if(size == 0)
+		return;
+	if(img->nb_segments == img->capacity)
+	{
+		img->capacity *= 2;
+		img->segments  = realloc(img->segments, sizeof(Out_Segment) * img->capacity);
+	}
+	img->segments[img->nb_segments++] = (Out_Segment) { offset, data, size, -1, 0 };
+}
+
+void add_out_file_segment(Out_Image *img, Elf32_Off offset, int fd, off_t src_offset, size_t size)
+{
+	add_out_segment(img, offset, NULL, size);
+	if(size == 0)
+		return;
+	img->segments[img->nb_segments - 1].fd         = fd;
+	img->segments[img->nb_segments - 1].src_offset = src_offset;
+}
+
+void add_out_patch(Out_Image *img, Elf32_Off offset, const void *data, size_t size)
+{
+	if(size == 0)
+		return;
+	if(img->nb_patches == img->patches_capacity)
+	{
+		img->patches_capacity *= 2;
+		img->patches = realloc(img->patches, sizeof(Out_Segment) * img->patches_capacity);
+	}
+	img->patches[img->nb_patches++] = (Out_Segment) { offset, data, size, -1, 0 };
+}
+
+void *alloc_out_segment(Out_Image *img, Elf32_Off offset, size_t size)
+{
+	void *data = calloc(1, size ? size : 1);
+
+	/* Un segment vide n'est pas ajouté à l'image, mais son bloc est quand même libéré avec elle */
+	add_out_segment(img, offset, data, size);
+	if(img->nb_owned == img->owned_capacity)
+	{
+		img->owned_capacity *= 2;
+		img->owned = realloc(img->owned, sizeof(void*) * img->owned_capacity);
+	}
+	img->owned[img->nb_owned++] = data;
+	return data;
+}
+
+static int compare_segments(const void *a, const void *b)
+{
+	const Out_Segment *sa = a, *sb = b;
+
+	return (sa->offset > sb->offset) - (sa->offset < sb->offset);
+}
+
+/* Écrit iovcnt vecteurs à partir de offset, en reprenant après une écriture partielle */
+static int pwritev_all(Out_Image *img, int fd, struct iovec *iov, int iovcnt, off_t offset)
+{
+	ssize_t w;
+
+	while(iovcnt > 0)
+	{
+		w = pwritev(fd, iov, iovcnt, offset);
+		img->nb_syscalls++;
+		if(w < 0)
+			return -1;
+		img->bytes_written += w;
+		offset += w;
+		while((iovcnt > 0) && ((size_t) w >= iov->iov_len))
+		{
+			w -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if(iovcnt > 0)
+		{
+			iov->iov_base = (char *) iov->iov_base + w;
+			iov->iov_len -= w;
+		}
+	}
+	return 0;
+}
+
+/* Recopie size octets de fd_in (à partir de off_in) dans fd_out (à partir de off_out) */
+static int copy_range(Out_Image *img, int fd_in, off_t off_in, int fd_out, off_t off_out, size_t size)
+{
+	ssize_t n;
+	unsigned char *buff;
+
+#ifdef __linux__
+	/* Le noyau recopie directement (voire partage les blocs, selon le système de fichiers) */
+	while(size > 0)
+	{
+		n = copy_file_range(fd_in, &off_in, fd_out, &off_out, size, 0);
+		img->nb_syscalls++;
+		if(n <= 0)
+			break;
+		img->bytes_read    += n;
+		img->bytes_written += n;
+		size -= n;
+	}
+	if(size == 0)
+		return 0;
+
+	/* sendfile écrit à la position courante du fichier de sortie */
+	img->nb_syscalls++;
+	if(lseek(fd_out, off_out, SEEK_SET) == off_out)
+		while(size > 0)
+		{
+			n = sendfile(fd_out, fd_in, &off_in, size);
+			img->nb_syscalls++;
+			if(n <= 0)
+				break;
+			img->bytes_read    += n;
+			img->bytes_written += n;
+			size    -= n;
+			off_out += n;
+		}
+	if(size == 0)
+		return 0;
+#endif
+
+	/* En dernier recours, on recopie par blocs de taille bornée */
+	buff = malloc(min(size, COPY_CHUNK));
+	while(size > 0)
+	{
+		n = pread(fd_in, buff, min(size, COPY_CHUNK), off_in);
+		img->nb_syscalls++;
+		if(n <= 0)
+			break;
+		img->bytes_read += n;
+		img->nb_syscalls++;
+		if(pwrite(fd_out, buff, n, off_out) != n)
+			break;
+		img->bytes_written += n;
+		size    -= n;
+		off_in  += n;
+		off_out += n;
+	}
+	free(buff);
+
+	return (size == 0) ? 0 : -1;
+}
+
+ssize_t write_out_image(int fd, Out_Image *img)
+{
+	struct iovec *iov;
+	unsigned nb_iov = 0, nb_alloc;
+	off_t start = 0, end = 0;
+	size_t pad;
+	int err = 0;
+
+	/* Au pire, chaque segment est précédé d'un trou qui tient dans un bloc de zéros */
+	qsort(img->segments, img->nb_segments, sizeof(Out_Segment), compare_segments);
+	nb_alloc = 2 * img->nb_segments + 1;
+	if(nb_alloc < min(img->nb_patches, IOV_MAX))
+		nb_alloc = min(img->nb_patches, IOV_MAX);
+	iov = malloc(sizeof(struct iovec) * nb_alloc);
+
+	for(unsigned i = 0; i < img->nb_segments; i++)
+	{
+		const Out_Segment *s = &img->segments[i];
+		if(s->offset < end)
+		{
+			fprintf(stderr, "ATTENTION : le segment à l'adresse de décalage %#x en recouvre un autre !\n", s->offset);
+			err = 1;
+			break;
+		}
+
+		/* Les grands trous sont sautés : on écrit ce qui précède et on repart de l'autre côté */
+		pad = s->offset - end;
+		if(pad > sizeof(zeros))
+		{
+			if((err = (pwritev_all(img, fd, iov, nb_iov, start) < 0)))
+				break;
+			nb_iov = 0;
+			start  = s->offset;
+		}
+		else if(pad > 0)
+			iov[nb_iov++] = (struct iovec) { (void *) zeros, pad };
+		end = s->offset + s->size;
+
+		/* Un segment pris dans un fichier interrompt le regroupement des pwritev */
+		if(s->data == NULL)
+		{
+			if((err = (pwritev_all(img, fd, iov, nb_iov, start) < 0) || (copy_range(img, s->fd, s->src_offset, fd, s->offset, s->size) < 0)))
+				break;
+			nb_iov = 0;
+			start  = end;
+			continue;
+		}
+		iov[nb_iov++] = (struct iovec) { (void *) s->data, s->size };
+
+		if(nb_iov + 2 > IOV_MAX)
+		{
+			if((err = (pwritev_all(img, fd, iov, nb_iov, start) < 0)))
+				break;
+			nb_iov = 0;
+			start  = end;
+		}
+	}
+
+	if(!err)
+		err = (pwritev_all(img, fd, iov, nb_iov, start) < 0);
+
+	/* Les correctifs recouvrent des segments déjà écrits ; les correctifs contigus sont regroupés */
+	qsort(img->patches, img->nb_patches, sizeof(Out_Segment), compare_segments);
+	nb_iov = 0;
+	for(unsigned i = 0; (i < img->nb_patches) && !err; i++)
+	{
+		const Out_Segment *s = &img->patches[i];
+		if((nb_iov == 0) || (s->offset != img->patches[i - 1].offset + img->patches[i - 1].size) || (nb_iov == IOV_MAX))
+		{
+			if((err = (pwritev_all(img, fd, iov, nb_iov, start) < 0)))
+				break;
+			nb_iov = 0;
+			start  = s->offset;
+		}
+		iov[nb_iov++] = (struct iovec) { (void *) s->data, s->size };
+		if(s->offset + s->size > end)
+			end = s->offset + s->size;
+	}
+	if(!err)
+		err = (pwritev_all(img, fd, iov, nb_iov, start) < 0);
+	free(iov);
+	if(err)
+		return -1;
+	TRACE(TRACE_IO, TRACE_STEPS, "Image de %li octets écrite en %u segments et %u correctifs\n", (long) end, img->nb_segments, img->nb_patches);
+
+	return end;
+}
+
+void destroy_out_image(Out_Image *img)
+{
+	for(unsigned i = 0; i < img->nb_owned; i++)
+		free(img->owned[i]);
+	free(img->owned);
+	free(img->patches);
+	free(img->segments);
+	free(img);
+}
@@ -0,0 +1,105 @@
+#ifndef _OUT_IMAGE_H_
+#define _OUT_IMAGE_H_
+
+#include <sys/types.h>
+#include <elf.h>
+
+typedef struct
+{
+	Elf32_Off offset; // Adresse de décalage du segment dans le fichier
+	const void *data; // Contenu du segment (non copié), ou NULL s'il est pris dans un fichier
+	size_t size;      // Taille du segment
+	int fd;           // Fichier d'où recopier le segment (si data vaut NULL)
+	off_t src_offset; // Adresse de décalage du segment dans ce fichier
+} Out_Segment;
+
+typedef struct
+{
+	Out_Segment *segments;            // Segments du fichier, dans l'ordre d'ajout
+	unsigned nb_segments;             // Nombre de segments
+	unsigned capacity;                // Nombre de segments pouvant être stockés sans réallocation
+	Out_Segment *patches;             // Correctifs, écrits par-dessus les segments qu'ils recouvrent
+	unsigned nb_patches;              // Nombre de correctifs
+	unsigned patches_capacity;        // Nombre de correctifs pouvant être stockés sans réallocation
+	void **owned;                     // Blocs alloués par alloc_out_segment, libérés avec l'image
+	unsigned nb_owned;                // Nombre de blocs alloués
+	unsigned owned_capacity;          // Nombre de blocs pouvant être retenus sans réallocation
+	unsigned long nb_syscalls;        // Appels système faits par write_out_image
+	unsigned long long bytes_read;    // Octets lus dans les fichiers d'entrée par write_out_image
+	unsigned long long bytes_written; // Octets écrits par write_out_image
+} Out_Image;
+
+/**
+ * Crée une image vide d'un fichier de sortie
+ *
+ * @param expected: le nombre de segments attendus (l'image s'agrandit au besoin)
+ * @retourne un pointeur sur une structure de type Out_Image
+ **/
+Out_Image *create_out_image(unsigned expected);
+
+/**
+ * Ajoute un segment à l'image ; son contenu n'est pas copié et doit rester valide
+ * jusqu'à l'appel à write_out_image
+ *
+ * @param img:    une structure de type Out_Image initialisée
+ * @param offset: l'adresse de décalage du segment dans le fichier
+ * @param data:   le contenu du segment
+ * @param size:   la taille du segment
+ **/
+void add_out_segment(Out_Image *img, Elf32_Off offset, const void *data, size_t size);
+
+/**
+ * Ajoute un segment à l'image, dont le contenu est recopié directement depuis un autre
+ * fichier au moment de l'écriture (copy_file_range, puis sendfile, puis par blocs)
+ *
+ * @param img:        une structure de type Out_Image initialisée
+ * @param offset:     l'adresse de décalage du segment dans le fichier
+ * @param fd:         un descripteur du fichier d'où recopier le segment
+ * @param src_offset: l'adresse de décalage du segment dans ce fichier
+ * @param size:       la taille du segment
+ **/
+void add_out_file_segment(Out_Image *img, Elf32_Off offset, int fd, off_t src_offset, size_t size);
+
+/**
+ * Ajoute un correctif à l'image : quelques octets écrits par-dessus un segment déjà ajouté
+ * (par exemple une valeur corrigée dans une section recopiée de fichier à fichier). Son contenu
+ * n'est pas copié et doit rester valide jusqu'à l'appel à write_out_image
+ *
+ * @param img:    une structure de type Out_Image initialisée
+ * @param offset: l'adresse de décalage du correctif dans le fichier
+ * @param data:   le contenu du correctif
+ * @param size:   la taille du correctif
+ **/
+void add_out_patch(Out_Image *img, Elf32_Off offset, const void *data, size_t size);
+
+/**
+ * Alloue un segment de l'image, à remplir par l'appelant
+ *
+ * @param img:    une structure de type Out_Image initialisée
+ * @param offset: l'adresse de décalage du segment dans le fichier
+ * @param size:   la taille du segment
+ * @retourne un pointeur sur le contenu du segment, libéré avec l'image
+ **/
+void *alloc_out_segment(Out_Image *img, Elf32_Off offset, size_t size);
+
+/**
+ * Écrit l'image dans un fichier avec le moins d'appels système possible : les segments en mémoire
+ * sont regroupés dans des pwritev, ceux pris dans un fichier sont recopiés sans passer par
+ * l'espace utilisateur quand c'est possible ; les trous entre les segments sont remplis de zéros.
+ * Les correctifs sont écrits ensuite, un pwritev par suite de correctifs contigus
+ *
+ * @param fd:  un descripteur de fichier ouvert en écriture
+ * @param img: une structure de type Out_Image initialisée
+ * @retourne le nombre d'octets écrits, ou -1 en cas d'erreur
+ **/
+ssize_t write_out_image(int fd, Out_Image *img);
+
+/**
+ * Libère la mémoire occupée par une structure Out_Image et par les segments qu'elle a alloués
+ *
+ * @param img: une structure de type Out_Image initialisée
+ **/
+void destroy_out_image(Out_Image *img);
+
+
+#endif
@@ -7,13 +7,17 @@
 #include <sys/stat.h>
 #include <ctype.h>
 #include <stdint.h>
+#include <limits.h>
 
 #include <elf.h>
+#include "elf_file.h"
 #include "elf_common.h"
 #include "section.h"
 #include "symbol.h"
 #include "relocation.h"
 #include "disp.h"
+#include "thread_pool.h"
+#include "text_buffer.h"
 #include "readelf.h"
 
 
@@ -31,6 +35,7 @@ static const struct
 	{ 's',  "syms",            no_argument,       "Affiche la table des symboles"                          },
 	{ 'r',  "relocs",          no_argument,       "Affiche les réalocations (si présentes)"                },
 	{ 'A',  "all",             no_argument,       "Similaire à -h -S -s -r"                                },
+	{ 'j',  "jobs",            required_argument, "Analyse N fichiers en parallèle (0 : un par cœur)"      },
 	{ 'H',  "help",            no_argument,       "Affiche cette aide et quitte"                           },
 	{ '\0', NULL,              0,               NULL                                                       }
 };
@@ -47,10 +52,15 @@ static void print_help(char *prgname)
 static int parse_options(int argc, char *argv[], Arguments *args)
 {
 	int c = 0, first_file = 1;
+	long jobs;
+	char *end;
 	char shortopts[64] = "";
 	struct option longopts[sizeof(opts)/sizeof(opts[0]) - 1];
 	args->display     = 0;
 	args->nb_hexdumps = 0;
+	args->capacity    = 0;
+	args->hexdumps    = NULL;
+	args->jobs        = 1;
 
 	for(int i = 0; opts[i].long_opt != NULL; i++)
 	{
@@ -75,16 +85,15 @@ static int parse_options(int argc, char *argv[], Arguments *args)
 				break;
 			case 'x':
 				args->display |= DSP_HEX_DUMP;
-				if(isdigit(optarg[0]))
+				if(args->nb_hexdumps == args->capacity)
 				{
-					args->section_ind[args->nb_hexdumps]    = atoi(optarg);
-					args->section_str[args->nb_hexdumps][0] = '\0';
+					args->capacity = (args->capacity > 0) ? 2 * args->capacity : 16;
+					args->hexdumps = realloc(args->hexdumps, sizeof(Hexdump_Request) * args->capacity);
 				}
+				if(isdigit(optarg[0]))
+					args->hexdumps[args->nb_hexdumps] = (Hexdump_Request) { atoi(optarg), "" };
 				else
-				{
-					args->section_ind[args->nb_hexdumps] = 0;
-					strcpy(args->section_str[args->nb_hexdumps], optarg);
-				}
+					args->hexdumps[args->nb_hexdumps] = (Hexdump_Request) { 0, optarg };
 				args->nb_hexdumps++;
 				if(argv[first_file][2] == '\0')
 					first_file++;
@@ -98,6 +107,18 @@ static int parse_options(int argc, char *argv[], Arguments *args)
 			case 'A':
 				args->display |= DSP_FILE_HEADER | DSP_SECTION_HEADERS | DSP_SYMS | DSP_RELOCS;
 				break;
+			case 'j':
+				/* Seul un 0 explicite demande un fil par cœur : tout autre nombre invalide est refusé */
+				jobs = isdigit(optarg[0]) ? strtol(optarg, &end, 10) : -1;
+				if((jobs < 0) || (*end != '\0') || (jobs > INT_MAX))
+				{
+					print_help(argv[0]);
+					exit(1);
+				}
+				args->jobs = (jobs > 0) ? jobs : get_nb_cores();
+				if(argv[first_file][2] == '\0')
+					first_file++;
+				break;
 			case 'H':
 				print_help(argv[0]);
 				exit(0);
@@ -111,46 +132,182 @@ static int parse_options(int argc, char *argv[], Arguments *args)
 	return first_file;
 }
 
-static int parse_file(const char *filename, Arguments *args)
+/* Les tables sont lues à la première demande ; une table illisible (ou dont l'en-tête ou la table
+ * des sections est illisible) reste à NULL, et l'erreur est dans lf->ef->error */
+static Elf32_Ehdr *get_header(Lazy_File *lf)
+{
+	if(lf->ehdr == NULL)
+		lf->ehdr = read_elf_header(lf->ef);
+	return lf->ehdr;
+}
+
+static Section_Table *get_sections(Lazy_File *lf)
+{
+	if((lf->secTab == NULL) && (get_header(lf) != NULL))
+		lf->secTab = read_sectionTable(lf->ef, lf->ehdr);
+	return lf->secTab;
+}
+
+static symbolTable *get_symbols(Lazy_File *lf)
 {
-	int fd;
-	Elf32_Ehdr *ehdr;
-	Section_Table *secTab;
-	symbolTable *symTabFull;
-	Data_Rel *drel;
-
-	fd = open(filename, O_RDONLY);
-	if(fd < 0)
+	if((lf->st == NULL) && (get_sections(lf) != NULL))
+		lf->st = read_symbolTable(lf->ef, lf->secTab);
+	return lf->st;
+}
+
+static Data_Rel *get_relocations(Lazy_File *lf)
+{
+	if((lf->drel == NULL) && (get_sections(lf) != NULL))
+		lf->drel = read_relocationTables(lf->ef, lf->secTab);
+	return lf->drel;
+}
+
+static int parse_file(const char *filename, Arguments *args, Text_Buffer *out, Text_Buffer *err)
+{
+	unsigned index;
+	int ret = 0;
+	Lazy_File lf = { NULL, NULL, NULL, NULL, NULL };
+
+	lf.ef = open_elf_file(filename);
+	if(lf.ef == NULL)
 	{
-		fprintf(stderr, "Impossible d'ouvrir le fichier %s.\n", filename);
+		append_format(err, "Impossible d'ouvrir le fichier %s.\n", filename);
 		return 1;
 	}
 
-	ehdr       = read_elf_header(fd);
-	secTab     = read_sectionTable(fd, ehdr);
-	symTabFull = read_symbolTable(fd, secTab);
-	drel       = read_relocationTables(fd, secTab);
-
-	if(args->display & DSP_FILE_HEADER)
-		dump_header(ehdr);
-	if(args->display & DSP_SECTION_HEADERS)
-		dump_section_header(secTab, ehdr->e_shoff);
-	if(args->display & DSP_HEX_DUMP)
-		for(int h = 0; h < args->nb_hexdumps; h++)
-			if(is_valid_section(secTab, args->section_str[h], &args->section_ind[h]))
-				dump_section(fd, secTab, args->section_ind[h]);
-	if(args->display & DSP_SYMS)
-		displ_symbolTable(symTabFull);
-	if(args->display & DSP_RELOCS)
-		dump_relocation(ehdr, secTab, symTabFull, drel);
-
-	close(fd);
-	destroy_elf_header(ehdr);
-	destroy_sectionTable(secTab);
-	destroy_symbolTable(symTabFull);
-	destroy_relocationTables(drel);
-
-	return 0;
+	/* Seules les tables utiles aux affichages demandés sont lues : -h ne lit que l'en-tête.
+	 * Elles sont toutes lues avant le premier affichage, pour ne rien afficher d'un fichier invalide */
+	if((get_header(&lf) == NULL)
+		|| ((args->display & (DSP_SECTION_HEADERS | DSP_HEX_DUMP | DSP_SYMS | DSP_RELOCS)) && (get_sections(&lf) == NULL))
+		|| ((args->display & (DSP_SYMS | DSP_RELOCS)) && (get_symbols(&lf) == NULL))
+		|| ((args->display & DSP_RELOCS) && (get_relocations(&lf) == NULL)))
+	{
+		append_format(err, "%s : %s\n", filename, lf.ef->error);
+		ret = 1;
+	}
+	else
+	{
+		if(args->display & DSP_FILE_HEADER)
+			dump_header(out, lf.ehdr);
+		if(args->display & DSP_SECTION_HEADERS)
+			dump_section_header(out, lf.secTab, lf.ehdr->e_shoff);
+		if(args->display & DSP_HEX_DUMP)
+			for(int h = 0; h < args->nb_hexdumps; h++)
+			{
+				/* Un nom est recherché dans chaque fichier : l'indice trouvé n'est pas conservé */
+				index = args->hexdumps[h].index;
+				if(is_valid_section(lf.secTab, args->hexdumps[h].name, &index, err))
+					dump_section(out, lf.ef, lf.secTab, index);
+			}
+		if(args->display & DSP_SYMS)
+			displ_symbolTable(out, lf.st);
+		if(args->display & DSP_RELOCS)
+			dump_relocation(out, lf.ehdr, lf.secTab, lf.st, lf.drel);
+	}
+
+	if(lf.drel != NULL)
+		destroy_relocationTables(lf.ef, lf.drel);
+	if(lf.st != NULL)
+		destroy_symbolTable(lf.st);
+	if(lf.secTab != NULL)
+		destroy_sectionTable(lf.ef, lf.secTab);
+	if(lf.ehdr != NULL)
+		destroy_elf_header(lf.ef, lf.ehdr);
+	close_elf_file(lf.ef);
+
+	return ret;
+}
+
+static int print_file(const char *filename, Arguments *args, int show_name, Text_Buffer *out, Text_Buffer *err)
+{
+	int ret;
+
+	if(show_name)
+		append_format(out, "Fichier \x1b[1m%s\x1b[0m :\n\n", filename);
+	ret = parse_file(filename, args, out, err);
+	append_str(out, "\n\n");
+
+	return ret;
+}
+
+/* Les erreurs d'un fichier sont écrites après ce qui le précède : la sortie standard est vidée d'abord */
+static void write_errors(Text_Buffer *out, Text_Buffer *err)
+{
+	if(err->size == 0)
+		return;
+	flush_text_buffer(out);
+	flush_text_buffer(err);
+}
+
+static void run_file_job(void *arg)
+{
+	File_Job *job = arg;
+
+	init_text_buffer(&job->output, -1);
+	init_text_buffer(&job->errors, -1);
+	job->ret = print_file(job->filename, job->args, job->show_name, &job->output, &job->errors);
+
+	pthread_mutex_lock(&job->batch->lock);
+	job->done = 1;
+	pthread_cond_broadcast(&job->batch->done);
+	pthread_mutex_unlock(&job->batch->lock);
+}
+
+static int print_files_in_parallel(char *filenames[], unsigned nb_files, Arguments *args)
+{
+	int ret = 0;
+	unsigned nb_jobs = (args->jobs < nb_files) ? args->jobs : nb_files;
+	unsigned submitted = 0, window;
+	Text_Buffer out, err;
+	Job_Batch batch;
+	File_Job *jobs = calloc(nb_files, sizeof(File_Job));
+	Thread_Pool *tp;
+
+	/* Il est inutile d'avoir plus de fils que de fichiers ; la borne MAX_JOBS garde la fenêtre sans débordement */
+	if(nb_jobs > MAX_JOBS)
+		nb_jobs = MAX_JOBS;
+	window = 4 * nb_jobs;
+	tp = create_thread_pool(nb_jobs);
+	init_text_buffer(&out, STDOUT_FILENO);
+	init_text_buffer(&err, STDERR_FILENO);
+	pthread_mutex_init(&batch.lock, NULL);
+	pthread_cond_init(&batch.done, NULL);
+	for(unsigned i = 0; i < nb_files; i++)
+	{
+		jobs[i].filename  = filenames[i];
+		jobs[i].args      = args;
+		jobs[i].show_name = (nb_files > 1);
+		jobs[i].batch     = &batch;
+	}
+
+	/* Les sorties sont écrites dans l'ordre de la ligne de commande ; seuls les fichiers
+	 * d'une fenêtre glissante sont en cours, pour borner la mémoire des sorties en attente */
+	for(unsigned next = 0; next < nb_files; next++)
+	{
+		while((submitted < nb_files) && (submitted < next + window))
+			submit_task(tp, run_file_job, &jobs[submitted++]);
+
+		pthread_mutex_lock(&batch.lock);
+		while(!jobs[next].done)
+			pthread_cond_wait(&batch.done, &batch.lock);
+		pthread_mutex_unlock(&batch.lock);
+
+		append_chars(&out, jobs[next].output.data, jobs[next].output.size);
+		append_chars(&err, jobs[next].errors.data, jobs[next].errors.size);
+		write_errors(&out, &err);
+		destroy_text_buffer(&jobs[next].output);
+		destroy_text_buffer(&jobs[next].errors);
+		ret += jobs[next].ret;
+	}
+
+	destroy_thread_pool(tp);
+	destroy_text_buffer(&out);
+	destroy_text_buffer(&err);
+	pthread_cond_destroy(&batch.done);
+	pthread_mutex_destroy(&batch.lock);
+	free(jobs);
+
+	return ret;
 }
 
 int main(int argc, char *argv[])
@@ -165,13 +322,22 @@ int main(int argc, char *argv[])
 	}
 
 	first_filename = parse_options(argc, argv, &args);
-	for(int i = first_filename; i < argc; i++)
+	if(args.jobs > 1)
+		ret = print_files_in_parallel(&argv[first_filename], argc - first_filename, &args);
+	else
 	{
-		if(first_filename < argc - 1)
-			printf("Fichier \x1b[1m%s\x1b[0m :\n\n", argv[i]);
-		ret += parse_file(argv[i], &args);
-		printf("\n\n");
+		Text_Buffer out, err;
+		init_text_buffer(&out, STDOUT_FILENO);
+		init_text_buffer(&err, STDERR_FILENO);
+		for(int i = first_filename; i < argc; i++)
+		{
+			ret += print_file(argv[i], &args, first_filename < argc - 1, &out, &err);
+			write_errors(&out, &err);
+		}
+		destroy_text_buffer(&out);
+		destroy_text_buffer(&err);
 	}
+	free(args.hexdumps);
 
 	return ret;
 }
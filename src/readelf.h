@@ -1,8 +1,14 @@
 #ifndef _READELF_H_
 #define _READELF_H_
 
+#include <pthread.h>
 #include <elf.h>
+#include "elf_file.h"
 #include "elf_common.h"
+#include "section.h"
+#include "symbol.h"
+#include "relocation.h"
+#include "text_buffer.h"
 
 #define DSP_FILE_HEADER     (1 << 0)
 #define DSP_SECTION_HEADERS (1 << 1)
@@ -10,13 +16,50 @@
 #define DSP_SYMS            (1 << 3)
 #define DSP_RELOCS          (1 << 4)
 
+#define MAX_JOBS 256 // Nombre maximal de fils d'analyse, quel que soit -j
+
+
+typedef struct
+{
+	unsigned index;   // Indice de la section à afficher (si name est vide)
+	const char *name; // Nom de la section à afficher, pris dans la ligne de commande (non copié)
+} Hexdump_Request;
 
 typedef struct
 {
 	unsigned display;
-	unsigned nb_hexdumps;
-	unsigned section_ind[32];
-	char     section_str[32][32];
+	unsigned nb_hexdumps;      // Nombre de sections à afficher en hexadécimal
+	unsigned capacity;         // Nombre de demandes pouvant être stockées dans hexdumps sans réallocation
+	Hexdump_Request *hexdumps; // Demandes d'affichage en hexadécimal, dans l'ordre de la ligne de commande
+	unsigned jobs;             // Nombre de fichiers analysés en parallèle (-j)
 } Arguments;
 
+/* Tables d'un fichier analysé, chacune décodée à sa première utilisation */
+typedef struct
+{
+	Elf_File *ef;
+	Elf32_Ehdr *ehdr;      // En-tête (NULL tant qu'il n'a pas été lu)
+	Section_Table *secTab; // Table des sections (NULL tant qu'elle n'a pas été lue)
+	symbolTable *st;       // Tables des symboles (NULL tant qu'elles n'ont pas été lues)
+	Data_Rel *drel;        // Tables de réimplantations (NULL tant qu'elles n'ont pas été lues)
+} Lazy_File;
+
+typedef struct
+{
+	pthread_mutex_t lock; // Protège le champ done des fichiers
+	pthread_cond_t done;  // Signalé chaque fois qu'un fichier est terminé
+} Job_Batch;
+
+typedef struct
+{
+	const char *filename; // Fichier à analyser
+	Arguments *args;      // Options de la ligne de commande
+	int show_name;        // Affiche le nom du fichier avant son contenu
+	Text_Buffer output;   // Sortie du fichier, écrite en mémoire par le fil qui l'a analysé
+	Text_Buffer errors;   // Erreurs du fichier, écrites en mémoire et affichées après output
+	int ret;              // Valeur retournée par parse_file
+	int done;             // Vaut 1 quand output et errors sont complètes
+	Job_Batch *batch;     // Lot auquel appartient le fichier
+} File_Job;
+
 #endif
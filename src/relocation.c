@@ -15,90 +15,97 @@
 #include "relocation.h"
 #include "disp.h"
 
-Data_Rel *read_relocationTables(int fd, Section_Table *secTab)
+Data_Rel *read_relocationTables(Elf_File *ef, Section_Table *secTab)
 {
-    unsigned ind, size;
-    Data_Rel *drel = malloc(sizeof(Data_Rel));
-
-    /* Initialisation */
-    drel->nb_rel  = 0;
-    drel->nb_rela = 0;
-    drel->e_rel   = NULL;
-    drel->e_rela  = NULL;
-    drel->a_rel   = NULL;
-    drel->a_rela  = NULL;
-    drel->i_rel   = NULL;
-    drel->i_rela  = NULL;
-    drel->rel     = NULL;
-    drel->rela    = NULL;
+    unsigned nb_rel = 0, nb_rela = 0, nb_entries;
+    size_t entries_size = 0;
+    const unsigned char *p;
+    unsigned char *block;
+    Rel_Section *s;
+    Elf32_Shdr *shdr;
+    Data_Rel *drel;
 
+    /* Premier passage : taille de l'arène */
     for(int i = 0; i < secTab->nb_sections; i++)
     {
-        lseek(fd, secTab->shdr[i]->sh_offset, SEEK_SET);
         if(secTab->shdr[i]->sh_type == SHT_REL)
         {
-            drel->nb_rel++;
-            ind  = drel->nb_rel - 1;
-            size = secTab->shdr[i]->sh_size / sizeof(Elf32_Rel);
-
-            /* Allocations */
-            drel->e_rel    = realloc(drel->e_rel, sizeof(unsigned)   * drel->nb_rel);
-            drel->a_rel    = realloc(drel->a_rel, sizeof(Elf32_Addr) * drel->nb_rel);
-            drel->i_rel    = realloc(drel->i_rel, sizeof(unsigned)   * drel->nb_rel);
-            drel->rel      = realloc(drel->rel,   sizeof(Elf32_Rel*) * drel->nb_rel);
-            drel->rel[ind] = malloc(sizeof(Elf32_Rel*) * size);
-            for(int j = 0; j < size; j++)
-                drel->rel[ind][j] = malloc(sizeof(Elf32_Rel));
-
-            drel->e_rel[ind] = size;
-            drel->a_rel[ind] = secTab->shdr[i]->sh_offset;
-            drel->i_rel[ind] = i;
-
-            /* Récupération de la table des réimplantations */
-            for(int j = 0; j < size; j++)
-            {
-                read(fd, &drel->rel[ind][j]->r_offset, sizeof(drel->rel[ind][j]->r_offset));
-                read(fd, &drel->rel[ind][j]->r_info,   sizeof(drel->rel[ind][j]->r_info));
-            }
+            nb_rel++;
+            entries_size += (secTab->shdr[i]->sh_size / sizeof(Elf32_Rel)) * sizeof(Elf32_Rel);
         }
         else if(secTab->shdr[i]->sh_type == SHT_RELA)
         {
-            drel->nb_rela++;
-            ind  = drel->nb_rela - 1;
-            size = secTab->shdr[i]->sh_size / sizeof(Elf32_Rela);
-
-            /* Allocations */
-            drel->e_rela    = realloc(drel->e_rela, sizeof(unsigned)    * drel->nb_rela);
-            drel->a_rela    = realloc(drel->a_rela, sizeof(Elf32_Addr)  * drel->nb_rela);
-            drel->i_rela    = realloc(drel->i_rela, sizeof(unsigned)    * drel->nb_rela);
-            drel->rela      = realloc(drel->rela,   sizeof(Elf32_Rela*) * drel->nb_rela);
-            drel->rela[ind] = malloc(sizeof(Elf32_Rela*) * size);
-            for(int j = 0; j < size; j++)
-                drel->rela[ind][j] = malloc(sizeof(Elf32_Rela));
+            nb_rela++;
+            entries_size += (secTab->shdr[i]->sh_size / sizeof(Elf32_Rela)) * sizeof(Elf32_Rela);
+        }
+    }
 
-            drel->e_rela[ind] = size;
-            drel->a_rela[ind] = secTab->shdr[i]->sh_offset;
-            drel->i_rela[ind] = i;
+    /* Une seule allocation : la structure, puis les descripteurs, puis les entrées */
+    block = arena_alloc(ef->arena, sizeof(Data_Rel) + sizeof(Rel_Section) * (nb_rel + nb_rela) + entries_size);
+    drel          = (Data_Rel *) block;
+    drel->nb_rel  = 0;
+    drel->nb_rela = 0;
+    drel->rel     = (Rel_Section *) (block + sizeof(Data_Rel));
+    drel->rela    = drel->rel + nb_rel;
+    block        += sizeof(Data_Rel) + sizeof(Rel_Section) * (nb_rel + nb_rela);
 
-            /* Récupération de la table des réimplantations */
-            for(int j = 0; j < size; j++)
-            {
-                read(fd, &drel->rela[ind][j]->r_offset, sizeof(drel->rela[ind][j]->r_offset));
-                read(fd, &drel->rela[ind][j]->r_info,   sizeof(drel->rela[ind][j]->r_info));
-                read(fd, &drel->rela[ind][j]->r_addend, sizeof(drel->rela[ind][j]->r_addend));
-            }
+    /* Second passage : récupération des tables, décodées d'un seul bloc chacune */
+    for(int i = 0; i < secTab->nb_sections; i++)
+    {
+        shdr = secTab->shdr[i];
+        if(shdr->sh_type == SHT_REL)
+        {
+            nb_entries = shdr->sh_size / sizeof(Elf32_Rel);
+            s  = &drel->rel[drel->nb_rel++];
+            *s = (Rel_Section) { i, shdr->sh_offset, nb_entries, (Elf32_Rel *) block, NULL };
+            if((p = get_elf_view_or_error(ef, shdr->sh_offset, nb_entries * sizeof(Elf32_Rel))) == NULL)
+                break;
+            decode_elf32_rel_array(&ef->dec, s->rel, p, nb_entries, sizeof(Elf32_Rel));
+            block += nb_entries * sizeof(Elf32_Rel);
+        }
+        else if(shdr->sh_type == SHT_RELA)
+        {
+            nb_entries = shdr->sh_size / sizeof(Elf32_Rela);
+            s  = &drel->rela[drel->nb_rela++];
+            *s = (Rel_Section) { i, shdr->sh_offset, nb_entries, NULL, (Elf32_Rela *) block };
+            if((p = get_elf_view_or_error(ef, shdr->sh_offset, nb_entries * sizeof(Elf32_Rela))) == NULL)
+                break;
+            decode_elf32_rela_array(&ef->dec, s->rela, p, nb_entries, sizeof(Elf32_Rela));
+            block += nb_entries * sizeof(Elf32_Rela);
         }
     }
 
+    /* Une table dépasse du fichier : l'erreur est dans ef->error */
+    if(ef->error[0] != '\0')
+    {
+        arena_free(ef->arena, drel);
+        return NULL;
+    }
     return drel;
 }
 
+Rel_Section *find_rel_section(Data_Rel *drel, unsigned index, int is_rela)
+{
+    Rel_Section *s = (!is_rela) ? drel->rel : drel->rela;
+    unsigned low = 0, high = (!is_rela) ? drel->nb_rel : drel->nb_rela, mid;
+
+    while(low < high)
+    {
+        mid = (low + high) / 2;
+        if(s[mid].index < index)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return ((low < ((!is_rela) ? drel->nb_rel : drel->nb_rela)) && (s[low].index == index)) ? &s[low] : NULL;
+}
+
 // static inline Elf32_Addr get_symbol_value_generic(symbolTable *symTabFull, Elf32_Word info)
 Elf32_Addr get_symbol_value_generic(symbolTable *symTabFull, Elf32_Word info)
 {
     return isDynamicRel(ELF32_R_TYPE(info)) ?
-        symTabFull->dynsym->tab[ELF32_R_SYM(info)]->st_value :
-        symTabFull->symtab->tab[ELF32_R_SYM(info)]->st_value;
+        symTabFull->dynsym->tab[ELF32_R_SYM(info)].st_value :
+        symTabFull->symtab->tab[ELF32_R_SYM(info)].st_value;
 }
 
 // static inline char *get_symbol_or_section_name(Section_Table *secTab, symbolTable *symTabFull, Elf32_Word info)
@@ -125,27 +132,7 @@ int isDynamicRel(int rel_type) {
     || (rel_type == R_ARM_RELATIVE));
 }
 
-void destroy_relocationTables(Data_Rel *drel)
+void destroy_relocationTables(Elf_File *ef, Data_Rel *drel)
 {
-    for(int i = 0; i < drel->nb_rel; i++)
-    {
-        for(int j = 0; j < drel->e_rel[i]; j++)
-            free(drel->rel[i][j]);
-        free(drel->rel[i]);
-    }
-    free(drel->rel);
-    for(int i = 0; i < drel->nb_rela; i++)
-    {
-        for(int j = 0; j < drel->e_rela[i]; j++)
-            free(drel->rela[i][j]);
-        free(drel->rela[i]);
-    }
-    free(drel->rela);
-    free(drel->e_rel);
-    free(drel->e_rela);
-    free(drel->a_rel);
-    free(drel->a_rela);
-    free(drel->i_rel);
-    free(drel->i_rela);
-    free(drel);
+    arena_free(ef->arena, drel);
 }
@@ -2,26 +2,47 @@
 #define _RELOCATION_H_
 
 #include <elf.h>
+#include "elf_file.h"
 
 typedef struct
 {
-    unsigned nb_rel, nb_rela;   // Nombre de sections concernées
-    unsigned *e_rel, *e_rela;   // Nombre d'entrées par sections
-    unsigned *i_rel, *i_rela;   // Index de la section correspondante
-    Elf32_Addr *a_rel, *a_rela; // Adresse de décalage par sections
-    Elf32_Rel  ***rel;
-    Elf32_Rela ***rela;
+    unsigned index;      // Index de la section correspondante
+    Elf32_Addr offset;   // Adresse de décalage de la section
+    unsigned nb_entries; // Nombre d'entrées de la section
+    Elf32_Rel  *rel;     // Entrées d'une section SHT_REL, contiguës (NULL sinon)
+    Elf32_Rela *rela;    // Entrées d'une section SHT_RELA, contiguës (NULL sinon)
+} Rel_Section;
+
+/* La structure, les descripteurs et toutes les entrées tiennent dans un seul bloc */
+typedef struct
+{
+    unsigned nb_rel, nb_rela; // Nombre de sections concernées
+    Rel_Section *rel;         // Descripteurs des sections SHT_REL
+    Rel_Section *rela;        // Descripteurs des sections SHT_RELA
 } Data_Rel;
 
 
 /**
- * Lis les tables de réimplantations et stocke les informations dans une structure
+ * Lis les tables de réimplantations et stocke les informations dans une structure,
+ * allouée d'un seul bloc avec toutes les entrées
  *
- * @param fd:     un descripteur de fichier (ELF32)
+ * @param ef:     une structure de type Elf_File initialisée (ELF32)
  * @param secTab: une structure de type Section_Table initialisée
- * @retourne un pointeur sur une struture de type Data_Rel
+ * @retourne un pointeur sur une struture de type Data_Rel, ou NULL si une table dépasse
+ * du fichier (l'erreur est dans ef->error)
+ **/
+Data_Rel *read_relocationTables(Elf_File *ef, Section_Table *secTab);
+
+/**
+ * Recherche la table de réimplantations d'une section (les descripteurs sont rangés
+ * par indice de section croissant)
+ *
+ * @param drel:    une structure de type Data_Rel initialisée
+ * @param index:   l'indice de la section de réimplantations
+ * @param is_rela: 1 pour chercher parmi les sections SHT_RELA, 0 parmi les SHT_REL
+ * @retourne un pointeur sur le descripteur, ou NULL si la section n'en a pas
  **/
-Data_Rel *read_relocationTables(int fd, Section_Table *secTab);
+Rel_Section *find_rel_section(Data_Rel *drel, unsigned index, int is_rela);
 
 /**
  * Renvoie si une relocation concerne un symbole dynamique ou non.
@@ -32,11 +53,12 @@ Data_Rel *read_relocationTables(int fd, Section_Table *secTab);
 int isDynamicRel(int rel_type);
 
 /**
- * Libère la mémoire occupée par une structure Data_Rel
+ * Libère la mémoire occupée par une structure Data_Rel (rien si elle est dans une arène)
  *
+ * @param ef:   le fichier ELF dont les tables ont été lues
  * @param drel: une structure de type Data_Rel initialisée
  **/
-void destroy_relocationTables(Data_Rel *drel);
+void destroy_relocationTables(Elf_File *ef, Data_Rel *drel);
 
 Elf32_Addr get_symbol_value_generic(symbolTable *symTabFull, Elf32_Word info);
 // static inline Elf32_Addr get_symbol_value_generic(symbolTable *symTabFull, Elf32_Word info);
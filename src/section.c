@@ -11,40 +11,47 @@
 #include "elf_common.h"
 #include "section.h"
 
-Section_Table *read_sectionTable(int fd, Elf32_Ehdr *ehdr)
+Section_Table *read_sectionTable(Elf_File *ef, Elf32_Ehdr *ehdr)
 {
-    Section_Table *secTab = malloc(sizeof(Section_Table));
-    secTab->shdr = malloc(sizeof(Elf32_Shdr*) * ehdr->e_shnum);
+    const unsigned char *p;
+    Elf32_Shdr *block;
+    Section_Table *secTab = arena_alloc(ef->arena, sizeof(Section_Table));
+    unsigned entsize = (ehdr->e_shentsize >= sizeof(Elf32_Shdr)) ? ehdr->e_shentsize : sizeof(Elf32_Shdr);
 
-    for(int i = 0; i < ehdr->e_shnum; i++)
+    /* Les en-têtes sont décodés d'un seul bloc ; shdr[i] pointe dans ce bloc */
+    secTab->shdr = arena_alloc(ef->arena, sizeof(Elf32_Shdr*) * ehdr->e_shnum);
+    block = arena_alloc(ef->arena, sizeof(Elf32_Shdr) * ehdr->e_shnum);
+    secTab->nb_sections      = ehdr->e_shnum;
+    secTab->sectionNameTable = NULL;
+    if(ehdr->e_shnum > 0)
     {
-        secTab->shdr[i] = malloc(sizeof(Elf32_Shdr));
-        lseek(fd, ehdr->e_shoff + i * ehdr->e_shentsize, SEEK_SET);
-        read(fd, &secTab->shdr[i]->sh_name,      sizeof(secTab->shdr[i]->sh_name));
-        read(fd, &secTab->shdr[i]->sh_type,      sizeof(secTab->shdr[i]->sh_type));
-        read(fd, &secTab->shdr[i]->sh_flags,     sizeof(secTab->shdr[i]->sh_flags));
-        read(fd, &secTab->shdr[i]->sh_addr,      sizeof(secTab->shdr[i]->sh_addr));
-        read(fd, &secTab->shdr[i]->sh_offset,    sizeof(secTab->shdr[i]->sh_offset));
-        read(fd, &secTab->shdr[i]->sh_size,      sizeof(secTab->shdr[i]->sh_size));
-        read(fd, &secTab->shdr[i]->sh_link,      sizeof(secTab->shdr[i]->sh_link));
-        read(fd, &secTab->shdr[i]->sh_info,      sizeof(secTab->shdr[i]->sh_info));
-        read(fd, &secTab->shdr[i]->sh_addralign, sizeof(secTab->shdr[i]->sh_addralign));
-        read(fd, &secTab->shdr[i]->sh_entsize,   sizeof(secTab->shdr[i]->sh_entsize));
+        p = get_elf_view_or_error(ef, ehdr->e_shoff, (ehdr->e_shnum - 1) * entsize + sizeof(Elf32_Shdr));
+        if(p != NULL)
+        {
+            decode_elf32_shdr_array(&ef->dec, block, p, ehdr->e_shnum, entsize);
+            for(int i = 0; i < ehdr->e_shnum; i++)
+                secTab->shdr[i] = &block[i];
+            secTab->sectionNameTable = get_name_table(ef, ehdr->e_shstrndx, secTab->shdr, ehdr->e_shnum);
+        }
+        if(secTab->sectionNameTable == NULL)
+        {
+            arena_free(ef->arena, block);
+            arena_free(ef->arena, secTab->shdr);
+            arena_free(ef->arena, secTab);
+            return NULL;
+        }
     }
 
-    secTab->nb_sections      = ehdr->e_shnum;
-    secTab->sectionNameTable = get_name_table(fd, ehdr->e_shstrndx, secTab->shdr);
-
     return secTab;
 }
 
-int is_valid_section(Section_Table *secTab, char *name, unsigned *index)
+int is_valid_section(Section_Table *secTab, const char *name, unsigned *index, Text_Buffer *err)
 {
     int i;
 
     if(*index >= secTab->nb_sections)
     {
-        fprintf(stderr, "La section %i n'existe pas.\n", *index);
+        append_format(err, "La section %i n'existe pas.\n", *index);
         return 0;
     }
 
@@ -55,7 +62,7 @@ int is_valid_section(Section_Table *secTab, char *name, unsigned *index)
 
         if((i == secTab->nb_sections) || strcmp(name, get_section_name(secTab, i)))
         {
-            fprintf(stderr, "La section '%s' n'existe pas.\n",name);
+            append_format(err, "La section '%s' n'existe pas.\n",name);
             return 0;
         }
         else
@@ -65,11 +72,10 @@ int is_valid_section(Section_Table *secTab, char *name, unsigned *index)
     return 1;
 }
 
-void destroy_sectionTable(Section_Table *secTab)
+void destroy_sectionTable(Elf_File *ef, Section_Table *secTab)
 {
-    for(int i = 0; i < secTab->nb_sections; i++)
-        free(secTab->shdr[i]);
-    free(secTab->shdr);
-    free(secTab->sectionNameTable);
-    free(secTab);
+    if(secTab->nb_sections > 0)
+        arena_free(ef->arena, secTab->shdr[0]);
+    arena_free(ef->arena, secTab->shdr);
+    arena_free(ef->arena, secTab);
 }
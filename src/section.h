@@ -2,26 +2,29 @@
 #define _SECTION_H
 
 #include <elf.h>
+#include "elf_file.h"
+#include "text_buffer.h"
 
 typedef struct
 {
     unsigned nb_sections;
-    char *sectionNameTable; // Table des noms de sections
+    char *sectionNameTable; // Table des noms de sections (dans la projection du fichier)
     Elf32_Shdr **shdr;
 } Section_Table;
 
 #define BYTES_COUNT     16
 #define BLOCKS_COUNT    4
-#define BYTES_PER_BLOCK BYTES_COUNT / BLOCKS_COUNT
+#define BYTES_PER_BLOCK (BYTES_COUNT / BLOCKS_COUNT)
 
 /**
  * Lis la table des sections et la table des noms de sections et stocke les informations dans une structure
  *
- * @param fd:   un descripteur de fichier (ELF32)
+ * @param ef:   une structure de type Elf_File initialisée (ELF32)
  * @param ehdr: une structure de type Elf32_Ehdr initialisée
- * @retourne un pointeur sur une structure de type Section_Table
+ * @retourne un pointeur sur une structure de type Section_Table, ou NULL si la table ou les noms
+ * de sections dépassent du fichier (l'erreur est dans ef->error)
  **/
-Section_Table *read_sectionTable(int fd, Elf32_Ehdr *ehdr);
+Section_Table *read_sectionTable(Elf_File *ef, Elf32_Ehdr *ehdr);
 
 /**
  * Recherche si le numéro de section ou le nom de section est valide
@@ -29,17 +32,19 @@ Section_Table *read_sectionTable(int fd, Elf32_Ehdr *ehdr);
  * @param secTab:      une structure de type Section_Table initialisée
  * @param name:        le nom d'une section
  * @param index:       le numéro d'une section
+ * @param err:         le tampon où écrire l'erreur si la section n'existe pas
  * @retourne une valeur non-nulle si la section est Val_GNU_MIPS_ABI_FP_DOUBLE
  * EFFET DE BORD: s'il s'agit d'un nom de section et qu'il est valide, index est mis à jour
  **/
-int is_valid_section(Section_Table *secTab, char *name, unsigned *index);
+int is_valid_section(Section_Table *secTab, const char *name, unsigned *index, Text_Buffer *err);
 
 /**
- * Libère la mémoire occupée par une structure Section_Table
+ * Libère la mémoire occupée par une structure Section_Table (rien si elle est dans une arène)
  *
+ * @param ef:     le fichier ELF dont la table a été lue
  * @param secTab: une structure de type Section_Table initialisée
  **/
-void destroy_sectionTable(Section_Table *secTab);
+void destroy_sectionTable(Elf_File *ef, Section_Table *secTab);
 
 
 #endif
@@ -0,0 +1,122 @@
+#define _GNU_SOURCE
+#include <string.h>
+#include <time.h>
+
+#include "stats.h"
+
+static long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void init_stats(Stats *s, Stats_Format format)
+{
+	memset(s, 0, sizeof(Stats));
+	s->format = format;
+	if(stats_enabled(s))
+		s->start = now_ns();
+}
+
+void end_stats_phase(Stats *s, const char *name, const char *unit, unsigned long items, const Stats_Counters *now, size_t peak)
+{
+	Phase_Stats *p;
+	long long t;
+
+	if(!stats_enabled(s) || (s->nb_phases == STATS_MAX_PHASES))
+		return;
+
+	t = now_ns();
+	p = &s->phase[s->nb_phases++];
+	p->name  = name;
+	p->unit  = unit;
+	p->items = items;
+	p->ns    = t - s->start;
+	p->peak  = peak;
+	p->delta.syscalls      = now->syscalls      - s->last.syscalls;
+	p->delta.bytes_read    = now->bytes_read    - s->last.bytes_read;
+	p->delta.bytes_written = now->bytes_written - s->last.bytes_written;
+	p->delta.allocations   = now->allocations   - s->last.allocations;
+	p->delta.alloc_bytes   = now->alloc_bytes   - s->last.alloc_bytes;
+
+	s->last  = *now;
+	s->start = t;
+}
+
+/* Comme append_padded, mais un caractère UTF-8 accentué compte pour un seul */
+static void append_column(Text_Buffer *out, const char *str, int width)
+{
+	int len = 0;
+
+	for(const char *c = str; *c != '\0'; c++)
+		len += ((*c & 0xc0) != 0x80);
+	if(width > 0)
+		for(; len < width; len++)
+			append_char(out, ' ');
+	append_str(out, str);
+	if(width < 0)
+		for(; len < -width; len++)
+			append_char(out, ' ');
+}
+
+static void print_stats_table(const Stats *s, Text_Buffer *out)
+{
+	static const char *titles[] = { "Étape", "Durée (ms)", "Appels sys.", "Octets lus", "Octets écrits",
+	                                "Allocations", "Octets alloués", "Pic arènes", "Éléments" };
+	static const int widths[] = { -16, 12, 12, 13, 14, 12, 15, 12, 10 };
+	Phase_Stats total = { "total", "", 0, 0, { 0, 0, 0, 0, 0 }, 0 };
+
+	for(int c = 0; c < sizeof(titles) / sizeof(titles[0]); c++)
+		append_column(out, titles[c], widths[c]);
+	append_char(out, '\n');
+
+	for(unsigned i = 0; i <= s->nb_phases; i++)
+	{
+		const Phase_Stats *p = (i < s->nb_phases) ? &s->phase[i] : &total;
+
+		append_column(out, p->name, widths[0]);
+		append_format(out, "%*.3f%*lu%*llu%*llu%*lu%*llu%*zu",
+			widths[1], p->ns / 1e6, widths[2], p->delta.syscalls, widths[3], p->delta.bytes_read,
+			widths[4], p->delta.bytes_written, widths[5], p->delta.allocations, widths[6], p->delta.alloc_bytes,
+			widths[7], p->peak);
+		if(i < s->nb_phases)
+			append_format(out, "%*lu %s", widths[8], p->items, p->unit);
+		append_char(out, '\n');
+
+		total.ns                  += p->ns;
+		total.delta.syscalls      += p->delta.syscalls;
+		total.delta.bytes_read    += p->delta.bytes_read;
+		total.delta.bytes_written += p->delta.bytes_written;
+		total.delta.allocations   += p->delta.allocations;
+		total.delta.alloc_bytes   += p->delta.alloc_bytes;
+		if(p->peak > total.peak)
+			total.peak = p->peak;
+	}
+}
+
+static void print_stats_json(const Stats *s, Text_Buffer *out)
+{
+	append_str(out, "{\"phases\": [");
+	for(unsigned i = 0; i < s->nb_phases; i++)
+	{
+		const Phase_Stats *p = &s->phase[i];
+
+		/* Les noms sont des constantes du programme, sans caractère à échapper */
+		append_format(out, "%s\n  {\"name\": \"%s\", \"ns\": %lld, \"syscalls\": %lu, \"bytes_read\": %llu, "
+			"\"bytes_written\": %llu, \"allocations\": %lu, \"allocated_bytes\": %llu, \"arena_peak\": %zu, "
+			"\"items\": %lu, \"unit\": \"%s\"}",
+			(i > 0) ? "," : "", p->name, p->ns, p->delta.syscalls, p->delta.bytes_read, p->delta.bytes_written,
+			p->delta.allocations, p->delta.alloc_bytes, p->peak, p->items, p->unit);
+	}
+	append_str(out, "\n]}\n");
+}
+
+void print_stats(const Stats *s, Text_Buffer *out)
+{
+	if(s->format == STATS_TABLE)
+		print_stats_table(s, out);
+	else if(s->format == STATS_JSON)
+		print_stats_json(s, out);
+}
@@ -0,0 +1,81 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <stddef.h>
+#include "text_buffer.h"
+
+/* Nombre maximal d'étapes mesurées */
+#define STATS_MAX_PHASES 16
+
+typedef enum { STATS_OFF, STATS_TABLE, STATS_JSON } Stats_Format;
+
+/* Compteurs cumulés depuis le début du programme ; une étape en retient la différence */
+typedef struct
+{
+	unsigned long syscalls;           // Appels système d'entrée-sortie
+	unsigned long long bytes_read;    // Octets lus (zones des projections demandées, copies de fichier à fichier)
+	unsigned long long bytes_written; // Octets écrits
+	unsigned long allocations;        // Nombre d'allocations dans les arènes
+	unsigned long long alloc_bytes;   // Octets distribués par les arènes
+} Stats_Counters;
+
+typedef struct
+{
+	const char *name;     // Nom de l'étape
+	const char *unit;     // Nature des éléments traités par l'étape
+	unsigned long items;  // Nombre d'éléments traités
+	long long ns;         // Durée de l'étape
+	Stats_Counters delta; // Compteurs de l'étape
+	size_t peak;          // Pic de mémoire des arènes pendant l'étape
+} Phase_Stats;
+
+typedef struct
+{
+	Stats_Format format;
+	unsigned nb_phases;
+	Phase_Stats phase[STATS_MAX_PHASES];
+	long long start;     // Début de l'étape en cours
+	Stats_Counters last; // Compteurs à la fin de l'étape précédente
+} Stats;
+
+/**
+ * Initialise les mesures ; sans mesures (STATS_OFF), les autres fonctions ne font rien
+ *
+ * @param s:      les mesures à initialiser
+ * @param format: le format d'affichage des mesures
+ **/
+void init_stats(Stats *s, Stats_Format format);
+
+/**
+ * Indique si les mesures sont actives, pour éviter de relever les compteurs sinon
+ *
+ * @param s: des mesures initialisées
+ * @retourne 1 si les mesures sont actives
+ **/
+static inline int stats_enabled(const Stats *s)
+{
+	return s->format != STATS_OFF;
+}
+
+/**
+ * Termine l'étape en cours et commence la suivante
+ *
+ * @param s:     des mesures initialisées
+ * @param name:  le nom de l'étape qui se termine
+ * @param unit:  la nature des éléments traités par l'étape
+ * @param items: le nombre d'éléments traités
+ * @param now:   les compteurs cumulés à la fin de l'étape
+ * @param peak:  le pic de mémoire des arènes pendant l'étape
+ **/
+void end_stats_phase(Stats *s, const char *name, const char *unit, unsigned long items, const Stats_Counters *now, size_t peak);
+
+/**
+ * Ajoute les mesures de toutes les étapes à un tampon, en tableau ou en JSON
+ *
+ * @param s:   des mesures initialisées
+ * @param out: un tampon initialisé
+ **/
+void print_stats(const Stats *s, Text_Buffer *out);
+
+
+#endif
@@ -0,0 +1,169 @@
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+
+#include "str_table.h"
+
+typedef struct
+{
+	const char *s; // Nom, dans l'ancienne table
+	unsigned len;  // Longueur du nom
+	unsigned k;    // Rang d'ajout du nom
+} Suffix_Entry;
+
+Str_Table *create_str_table(unsigned expected)
+{
+	Str_Table *st = malloc(sizeof(Str_Table));
+
+	st->capacity = 64;
+	st->data     = malloc(st->capacity);
+	st->data[0]  = '\0';
+	st->size     = 1;
+	st->index    = create_name_index(expected);
+	st->remap    = NULL;
+	st->handles  = NULL;
+	st->nb_names = 0;
+
+	return st;
+}
+
+static void reserve_str_table(Str_Table *st, Elf32_Word needed)
+{
+	Name_Index *ni = st->index;
+
+	if(st->size + needed <= st->capacity)
+		return;
+	while(st->size + needed > st->capacity)
+		st->capacity *= 2;
+	st->data = realloc(st->data, st->capacity);
+
+	/* Les noms indexés pointent dans data : on les replace dans le nouveau bloc */
+	for(unsigned i = 0; i <= ni->mask; i++)
+		if(ni->entries[i].name != NULL)
+			ni->entries[i].name = st->data + ni->entries[i].value;
+}
+
+Elf32_Word add_in_str_table(Str_Table *st, const char *name)
+{
+	Elf32_Word len = strlen(name), offset;
+
+	if(len == 0)
+		return 0;
+
+	/* On recopie le nom à la fin de la table ; il n'y restera que s'il est nouveau */
+	reserve_str_table(st, len + 1);
+	memcpy(st->data + st->size, name, len + 1);
+	offset = add_in_name_index(st->index, st->data + st->size, st->size);
+	if(offset == st->size)
+		st->size += len + 1;
+
+	return offset;
+}
+
+static int compare_reversed(const void *a, const void *b)
+{
+	const Suffix_Entry *ea = a, *eb = b;
+	unsigned i;
+
+	for(i = 1; (i <= ea->len) && (i <= eb->len); i++)
+		if(ea->s[ea->len - i] != eb->s[eb->len - i])
+			return (unsigned char) ea->s[ea->len - i] - (unsigned char) eb->s[eb->len - i];
+
+	return (int) ea->len - (int) eb->len;
+}
+
+void finalize_str_table(Str_Table *st, int merge_suffixes)
+{
+	unsigned n = st->index->nb_entries, k = 0;
+	Suffix_Entry *e;
+	int *parent;
+	char *data;
+	Elf32_Word size = 1;
+
+	destroy_name_index(st->index);
+	st->index    = NULL;
+	st->nb_names = n;
+	if(!merge_suffixes || (n == 0))
+		return;
+
+	/* Les noms sont rangés les uns à la suite des autres, dans l'ordre d'ajout */
+	e           = malloc(sizeof(Suffix_Entry) * n);
+	parent      = malloc(sizeof(int) * n);
+	st->remap   = malloc(sizeof(Elf32_Word) * n);
+	st->handles = malloc(sizeof(Elf32_Word) * n);
+	for(Elf32_Word off = 1; off < st->size; off += e[k++].len + 1)
+	{
+		e[k].s   = st->data + off;
+		e[k].len = strlen(e[k].s);
+		e[k].k   = k;
+		st->handles[k] = off;
+	}
+
+	/* Une fois triés à l'envers, un nom est suivi des noms dont il est le suffixe */
+	qsort(e, n, sizeof(Suffix_Entry), compare_reversed);
+	parent[e[n - 1].k] = -1;
+	for(int i = n - 2, last = n - 1; i >= 0; i--)
+	{
+		if((e[i].len <= e[last].len) && !memcmp(e[last].s + e[last].len - e[i].len, e[i].s, e[i].len))
+			parent[e[i].k] = last;
+		else
+		{
+			parent[e[i].k] = -1;
+			last = i;
+		}
+	}
+
+	/* On conserve l'ordre d'ajout pour les noms qui ne sont pas des suffixes */
+	data    = malloc(st->size);
+	data[0] = '\0';
+	for(k = 0; k < n; k++)
+	{
+		if(parent[k] != -1)
+			continue;
+		memcpy(data + size, st->data + st->handles[k], strlen(st->data + st->handles[k]) + 1);
+		st->remap[k] = size;
+		size += strlen(data + size) + 1;
+	}
+	for(int i = 0; i < n; i++)
+		if(parent[e[i].k] != -1)
+		{
+			const Suffix_Entry *p = &e[parent[e[i].k]];
+			st->remap[e[i].k] = st->remap[p->k] + p->len - e[i].len;
+		}
+
+	free(st->data);
+	free(parent);
+	free(e);
+	st->data     = data;
+	st->size     = size;
+	st->capacity = size;
+}
+
+Elf32_Word get_str_table_offset(Str_Table *st, Elf32_Word handle)
+{
+	unsigned low = 0, high = st->nb_names, mid;
+
+	if((st->remap == NULL) || (handle == 0))
+		return handle;
+
+	/* Les anciens indices sont croissants dans l'ordre d'ajout */
+	while(high - low > 1)
+	{
+		mid = (low + high) / 2;
+		if(st->handles[mid] <= handle)
+			low = mid;
+		else
+			high = mid;
+	}
+	return st->remap[low];
+}
+
+void destroy_str_table(Str_Table *st)
+{
+	if(st->index != NULL)
+		destroy_name_index(st->index);
+	free(st->remap);
+	free(st->handles);
+	free(st->data);
+	free(st);
+}
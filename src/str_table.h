@@ -0,0 +1,62 @@
+#ifndef _STR_TABLE_H_
+#define _STR_TABLE_H_
+
+#include <elf.h>
+#include "name_index.h"
+
+typedef struct
+{
+	char *data;          // Contenu de la table (commence toujours par '\0')
+	Elf32_Word size;     // Taille utilisée de data
+	Elf32_Word capacity; // Taille allouée de data
+	Name_Index *index;   // Index des noms déjà présents (nom -> indice dans data)
+	unsigned nb_names;   // Après finalize_str_table : nombre de noms distincts
+	Elf32_Word *remap;   // Après finalize_str_table : nouvel indice de chaque nom, dans l'ordre d'ajout
+	Elf32_Word *handles; // Après finalize_str_table : ancien indice de chaque nom, dans l'ordre d'ajout
+} Str_Table;
+
+/**
+ * Crée une table de chaînes vide, qui ne contient que la chaîne vide à l'indice 0
+ *
+ * @param expected: le nombre de noms attendus (la table s'agrandit au besoin)
+ * @retourne un pointeur sur une structure de type Str_Table
+ **/
+Str_Table *create_str_table(unsigned expected);
+
+/**
+ * Ajoute un nom dans une table de chaînes, sauf s'il y est déjà
+ *
+ * @param st:   une structure de type Str_Table initialisée
+ * @param name: le nom à ajouter
+ * @retourne l'indice du nom dans la table (à convertir avec get_str_table_offset après finalize_str_table)
+ **/
+Elf32_Word add_in_str_table(Str_Table *st, const char *name);
+
+/**
+ * Termine la construction d'une table de chaînes. Si merge_suffixes est non nul,
+ * un nom qui est le suffixe d'un autre partage la fin de celui-ci (ex : "bar" et "foobar"),
+ * comme le fait ld ; les indices retournés par add_in_str_table changent alors
+ *
+ * @param st:             une structure de type Str_Table initialisée
+ * @param merge_suffixes: active la fusion des suffixes
+ **/
+void finalize_str_table(Str_Table *st, int merge_suffixes);
+
+/**
+ * Convertit un indice retourné par add_in_str_table en indice dans la table finale
+ *
+ * @param st:     une structure de type Str_Table initialisée
+ * @param handle: un indice retourné par add_in_str_table
+ * @retourne l'indice du nom dans la table finale
+ **/
+Elf32_Word get_str_table_offset(Str_Table *st, Elf32_Word handle);
+
+/**
+ * Libère la mémoire occupée par une structure Str_Table
+ *
+ * @param st: une structure de type Str_Table initialisée
+ **/
+void destroy_str_table(Str_Table *st);
+
+
+#endif
@@ -13,8 +13,8 @@
 #include "symbol.h"
 
 
-char *get_symbol_name(Elf32_Sym **symtab, char *table, unsigned index) {
-	return &(table[symtab[index]->st_name]);
+char *get_symbol_name(Elf32_Sym *symtab, char *table, unsigned index) {
+	return &(table[symtab[index].st_name]);
 }
 
 char *get_static_symbol_name(symbolTable *st, unsigned index) {
@@ -25,83 +25,108 @@ char *get_dynamic_symbol_name(symbolTable *st, unsigned index) {
 	return get_symbol_name(st->dynsym->tab, st->dynsym->symbolNameTable, index);
 }
 
-Elf32_Sym **read_Elf32_Sym(int fd, Elf32_Shdr **shdr, int *nbSymbol, int sectionIndex) {
+Elf32_Sym *read_Elf32_Sym(Elf_File *ef, Elf32_Shdr **shdr, int *nbSymbol, int sectionIndex) {
 
-	Elf32_Sym **symtab;
+	Elf32_Sym *symtab = NULL;
+	const unsigned char *p;
+	unsigned entsize;
 
 	if(sectionIndex != -1) {
-		*nbSymbol = shdr[sectionIndex]->sh_size / shdr[sectionIndex]->sh_entsize; // Nombre de symboles dans la table.
-
-		symtab = malloc(*nbSymbol * sizeof(Elf32_Sym*));
-		for (int j = 0; j < *nbSymbol; ++j) {
-			symtab[j] = malloc(sizeof(Elf32_Sym));
-
-			lseek(fd, shdr[sectionIndex]->sh_offset + j * shdr[sectionIndex]->sh_entsize, SEEK_SET);
-
-			read(fd, &symtab[j]->st_name, sizeof(symtab[j]->st_name));
-			read(fd, &symtab[j]->st_value, sizeof(symtab[j]->st_value));
-			read(fd, &symtab[j]->st_size, sizeof(symtab[j]->st_size));
-			read(fd, &symtab[j]->st_info, sizeof(symtab[j]->st_info));
-			read(fd, &symtab[j]->st_other, sizeof(symtab[j]->st_other));
-			read(fd, &symtab[j]->st_shndx, sizeof(symtab[j]->st_shndx));
+		entsize = (shdr[sectionIndex]->sh_entsize >= sizeof(Elf32_Sym)) ? shdr[sectionIndex]->sh_entsize : sizeof(Elf32_Sym);
+		*nbSymbol = shdr[sectionIndex]->sh_size / entsize; // Nombre de symboles dans la table.
+
+		symtab = arena_alloc(ef->arena, *nbSymbol * sizeof(Elf32_Sym));
+		if (*nbSymbol > 0) {
+			p = get_elf_view_or_error(ef, shdr[sectionIndex]->sh_offset, (*nbSymbol - 1) * entsize + sizeof(Elf32_Sym));
+			if (p == NULL) {
+				arena_free(ef->arena, symtab);
+				*nbSymbol = 0;
+				return NULL;
+			}
+			decode_elf32_sym_array(&ef->dec, symtab, p, *nbSymbol, entsize);
 		}
 	}
 	return symtab;
 }
 
-Symtab_Struct *read_symtab_struct(int fd, Section_Table *secTab, int shType) {
+Symtab_Struct *read_symtab_struct(Elf_File *ef, Section_Table *secTab, int shType) {
 	int tmpSymtabIndex = -1,
 		tmpStrtabIndex = -1;
 
 	Symtab_Struct *s;
-	s = malloc(sizeof(Symtab_Struct));
+	s = arena_alloc(ef->arena, sizeof(Symtab_Struct));
 
 	// Init
+	s->arena = ef->arena;
 	s->strIndex = -1;
 	s->nbSymbol = 0;
+	s->capacity = 0;
 	s->tab = NULL;
 	s->name = NULL;
 	s->symbolNameTable = NULL;
 
 	tmpSymtabIndex = get_section_index(secTab, shType);
 	if (tmpSymtabIndex != -1) {
-		s->tab = read_Elf32_Sym(fd,secTab->shdr, &s->nbSymbol, tmpSymtabIndex);
+		s->tab = read_Elf32_Sym(ef, secTab->shdr, &s->nbSymbol, tmpSymtabIndex);
+		s->capacity = s->nbSymbol;
 		if (s->tab != NULL) {
 			tmpStrtabIndex = secTab->shdr[tmpSymtabIndex]->sh_link;
 			s->strIndex = tmpStrtabIndex;
-			s->symbolNameTable = get_name_table(fd, tmpStrtabIndex, secTab->shdr);
+			s->symbolNameTable = get_name_table(ef, tmpStrtabIndex, secTab->shdr, secTab->nb_sections);
 			s->name = get_section_name(secTab,tmpSymtabIndex);
 		}
+		// La table ou ses noms dépassent du fichier
+		if (ef->error[0] != '\0') {
+			destroy_symtab_struct(s);
+			return NULL;
+		}
 	}
 	return s;
 }
 
-symbolTable *read_symbolTable(int fd, Section_Table *secTab) {
+symbolTable *read_symbolTable(Elf_File *ef, Section_Table *secTab) {
 	symbolTable *symTabToRead;
-	symTabToRead = malloc(sizeof(symbolTable));
+	symTabToRead = arena_alloc(ef->arena, sizeof(symbolTable));
 	// initialisation
 	symTabToRead->symtab = NULL;
 	symTabToRead->dynsym = NULL;
 
-	symTabToRead->dynsym = read_symtab_struct(fd, secTab, SHT_DYNSYM);
-	symTabToRead->symtab = read_symtab_struct(fd, secTab, SHT_SYMTAB);
+	symTabToRead->dynsym = read_symtab_struct(ef, secTab, SHT_DYNSYM);
+	symTabToRead->symtab = read_symtab_struct(ef, secTab, SHT_SYMTAB);
 
+	if (symTabToRead->dynsym == NULL || symTabToRead->symtab == NULL) {
+		if (symTabToRead->dynsym != NULL)
+			destroy_symtab_struct(symTabToRead->dynsym);
+		if (symTabToRead->symtab != NULL)
+			destroy_symtab_struct(symTabToRead->symtab);
+		arena_free(ef->arena, symTabToRead);
+		return NULL;
+	}
 	return symTabToRead;
 }
 
 
+int append_symbol(Symtab_Struct *s, const Elf32_Sym *sym) {
+	if (s->nbSymbol == s->capacity) {
+		s->capacity = (s->capacity > 0) ? 2 * s->capacity : 16;
+		s->tab = arena_realloc(s->arena, s->tab, s->nbSymbol * sizeof(Elf32_Sym), s->capacity * sizeof(Elf32_Sym));
+	}
+	s->tab[s->nbSymbol] = *sym;
+
+	return s->nbSymbol++;
+}
+
 void destroy_symtab_struct(Symtab_Struct *s) {
-	for(int i = 0; i < s->nbSymbol; i++)
-		free(s->tab[i]);
-	free(s->tab);
-	free(s->symbolNameTable);
-	free(s);
+	arena_free(s->arena, s->tab);
+	arena_free(s->arena, s);
 }
 
 // Gestion Memoire
 void destroy_symbolTable(symbolTable *st) {
+	Arena *arena = st->symtab->arena;
+
 	destroy_symtab_struct(st->symtab);
 	destroy_symtab_struct(st->dynsym);
 
-	free(st);
+	arena_free(arena, st);
 }
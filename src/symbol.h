@@ -6,11 +6,13 @@
 
 typedef struct
 {
-    Elf32_Sym **tab; // Table des symnoles
+    Elf32_Sym *tab; // Table des symboles, contiguë en mémoire
     char *name; // Nom de la table des symboles
-    char *symbolNameTable; // Table des noms de symboles
+    char *symbolNameTable; // Table des noms de symboles (dans la projection du fichier)
     int nbSymbol; // Nombre de symboles
+    int capacity; // Nombre de symboles pouvant être stockés dans tab sans réallocation
     int strIndex; // Index de la table des noms ?
+    Arena *arena; // Arène où est allouée tab (NULL : malloc)
 } Symtab_Struct;
 
 typedef struct
@@ -24,12 +26,12 @@ typedef struct
 /**
  * Retourne le nom d'un symbole donné (par index)
  *
- * @param symtab:  un tableau de structure Elf32_Sym initialisé.
+ * @param symtab:  une table contiguë de structures Elf32_Sym initialisée.
  * @param table: une chaîne de caractères initialisée contenant la table des noms de section.
  * @param index: le numéro d'une section.
  * @retourne une chaîne de caractères correspondant au nom du symbole.
  **/
-char *get_symbol_name(Elf32_Sym **symtab, char *table, unsigned index);
+char *get_symbol_name(Elf32_Sym *symtab, char *table, unsigned index);
 
 /**
  * Retourne le nom d'un symbole statique donné (par index)
@@ -51,35 +53,47 @@ char *get_dynamic_symbol_name(symbolTable *st, unsigned index);
 
 /**
  * Lis la table des symboles d'un fichiers ELF 32 bits,
- * stocke et retourne les informations dans un tableau de structures
+ * stocke et retourne les informations dans un unique bloc de structures
  *
- * @param fd:   un descripteur de fichier (ELF32)
+ * @param ef:   une structure de type Elf_File initialisée (ELF32)
  * @param shdr: un tableau de structures de type Elf32_Shdr
  * @param idxStrTab: indice de la section .strtab
- * @retourne: le tableau de structure.
+ * @retourne: le tableau de structure, ou NULL si la table dépasse du fichier (l'erreur est dans ef->error).
  **/
-Elf32_Sym **read_Elf32_Sym(int fd, Elf32_Shdr **shdr, int *nbSymbol, int sectionIndex);
+Elf32_Sym *read_Elf32_Sym(Elf_File *ef, Elf32_Shdr **shdr, int *nbSymbol, int sectionIndex);
 
 
 /**
  * Crée et remplie une structure Symtab_Struct (".symtab" ou ".dynsym")
  *
- * @param fd:   un descripteur de fichier (ELF32)
+ * @param ef:   une structure de type Elf_File initialisée (ELF32)
  * @param secTab: une structure de type Section_Table initialisée
  * @param shType: le type de la table des symbole (SHT_DYNSYM / SHT_SYMTAB)
- * @retourne: une structure Symtab_Struct remplie.
+ * @retourne: une structure Symtab_Struct remplie, ou NULL si la table ou ses noms dépassent
+ * du fichier (l'erreur est dans ef->error).
  **/
-Symtab_Struct *read_symtab_struct(int fd, Section_Table *secTab, int shType);
+Symtab_Struct *read_symtab_struct(Elf_File *ef, Section_Table *secTab, int shType);
 
 /*
  * Lit est crée un structure contenant le contenu des tables de symbole .symtab et .dynsym
  *
- * @param fd:     un descripteur de fichier (ELF32)
+ * @param ef:     une structure de type Elf_File initialisée (ELF32)
  * @param sectab: une structure de type Section_Table initialisée
  *
- * @retourne: un pointeur vers une structure symbolTable.
+ * @retourne: un pointeur vers une structure symbolTable, ou NULL si l'une des tables n'a pas
+ * pu être lue (l'erreur est dans ef->error).
  */
-symbolTable *read_symbolTable(int fd, Section_Table *secTab);
+symbolTable *read_symbolTable(Elf_File *ef, Section_Table *secTab);
+
+/**
+ * Ajoute un symbole à la fin d'une table des symboles, en agrandissant
+ * géométriquement le bloc de symboles si nécessaire
+ *
+ * @param s:   une structure de type Symtab_Struct initialisée
+ * @param sym: le symbole à copier dans la table
+ * @retourne l'indice où le nouveau symbole a été ajouté
+ **/
+int append_symbol(Symtab_Struct *s, const Elf32_Sym *sym);
 
 /**
  * Libère la mémoire occupée par une structure Symtab_Struct
@@ -95,7 +109,7 @@ void destroy_symtab_struct(Symtab_Struct *s);
  **/
 void destroy_symbolTable(symbolTable *st);
 
-char *get_symbol_name(Elf32_Sym **symtab, char *table, unsigned index);
+char *get_symbol_name(Elf32_Sym *symtab, char *table, unsigned index);
 
 char *get_static_symbol_name(symbolTable *st, unsigned index);
 
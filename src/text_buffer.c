@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "text_buffer.h"
+
+/* Taille du tampon quand il est vidé dans un fichier */
+#define TEXT_BUFFER_SIZE (1 << 20)
+
+static const char hex_digits[16] = "0123456789abcdef";
+
+void init_text_buffer(Text_Buffer *tb, int fd)
+{
+	tb->fd       = fd;
+	tb->size     = 0;
+	tb->capacity = (fd >= 0) ? TEXT_BUFFER_SIZE : 4096;
+	tb->data     = malloc(tb->capacity);
+}
+
+char *reserve_text_buffer(Text_Buffer *tb, size_t n)
+{
+	if(tb->size + n <= tb->capacity)
+		return tb->data + tb->size;
+
+	if(tb->fd >= 0)
+		flush_text_buffer(tb);
+	if(tb->size + n > tb->capacity)
+	{
+		while(tb->size + n > tb->capacity)
+			tb->capacity *= 2;
+		tb->data = realloc(tb->data, tb->capacity);
+	}
+	return tb->data + tb->size;
+}
+
+void append_chars(Text_Buffer *tb, const char *s, size_t n)
+{
+	memcpy(reserve_text_buffer(tb, n), s, n);
+	tb->size += n;
+}
+
+void append_str(Text_Buffer *tb, const char *s)
+{
+	append_chars(tb, s, strlen(s));
+}
+
+void append_char(Text_Buffer *tb, char c)
+{
+	*reserve_text_buffer(tb, 1) = c;
+	tb->size++;
+}
+
+void append_padded(Text_Buffer *tb, const char *s, int width)
+{
+	size_t len = strlen(s), pad = 0;
+	char *p;
+
+	if((width < 0) && (len < (size_t) -width))
+		pad = -width - len;
+	else if((width > 0) && (len < (size_t) width))
+		pad = width - len;
+
+	p = reserve_text_buffer(tb, len + pad);
+	if(width > 0)
+	{
+		memset(p, ' ', pad);
+		memcpy(p + pad, s, len);
+	}
+	else
+	{
+		memcpy(p, s, len);
+		memset(p + len, ' ', pad);
+	}
+	tb->size += len + pad;
+}
+
+void append_hex(Text_Buffer *tb, uint32_t value, int digits)
+{
+	int n = 1;
+	char *p;
+
+	/* Nombre de chiffres significatifs */
+	while((n < 8) && (value >> (4 * n)))
+		n++;
+	if(n < digits)
+		n = digits;
+
+	p = reserve_text_buffer(tb, n);
+	tb->size += n;
+	for(int i = n - 1; i >= 0; i--, value >>= 4)
+		p[i] = hex_digits[value & 0xf];
+}
+
+void append_dec(Text_Buffer *tb, int32_t value, int width)
+{
+	char digits[12];
+	int n = 0, len;
+	uint32_t v = (value < 0) ? -(uint32_t) value : (uint32_t) value;
+	char *p;
+
+	/* Les chiffres sont produits à l'envers */
+	do
+	{
+		digits[n++] = '0' + v % 10;
+		v /= 10;
+	} while(v != 0);
+	if(value < 0)
+		digits[n++] = '-';
+
+	len = (n < width) ? width : n;
+	p   = reserve_text_buffer(tb, len);
+	memset(p, ' ', len - n);
+	for(int i = 0; i < n; i++)
+		p[len - 1 - i] = digits[i];
+	tb->size += len;
+}
+
+void append_vformat(Text_Buffer *tb, const char *format, va_list aptr)
+{
+	va_list copy;
+	int n;
+
+	va_copy(copy, aptr);
+	n = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+
+	/* vsnprintf écrit aussi le '\0' final, qui ne compte pas dans size */
+	vsnprintf(reserve_text_buffer(tb, n + 1), n + 1, format, aptr);
+	tb->size += n;
+}
+
+void append_format(Text_Buffer *tb, const char *format, ...)
+{
+	va_list aptr;
+
+	va_start(aptr, format);
+	append_vformat(tb, format, aptr);
+	va_end(aptr);
+}
+
+int flush_text_buffer(Text_Buffer *tb)
+{
+	size_t done = 0, size = tb->size;
+	ssize_t n;
+
+	if(tb->fd < 0)
+		return 0;
+
+	while(done < size)
+	{
+		n = write(tb->fd, tb->data + done, size - done);
+		if((n < 0) && (errno == EINTR))
+			continue;
+		if(n <= 0)
+			break;
+		done += n;
+	}
+	tb->size = 0;
+
+	return (done == size) ? 0 : -1;
+}
+
+void destroy_text_buffer(Text_Buffer *tb)
+{
+	flush_text_buffer(tb);
+	free(tb->data);
+	tb->data = NULL;
+}
@@ -0,0 +1,120 @@
+#ifndef _TEXT_BUFFER_H_
+#define _TEXT_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+typedef struct
+{
+	int fd;          // Fichier où vider le tampon quand il est plein (-1 : le tampon grandit en mémoire)
+	char *data;      // Texte en attente
+	size_t size;     // Taille utilisée de data
+	size_t capacity; // Taille allouée de data
+} Text_Buffer;
+
+/**
+ * Initialise un tampon de texte
+ *
+ * @param tb: le tampon à initialiser
+ * @param fd: le fichier où écrire le texte par gros blocs, ou -1 pour garder tout le texte en mémoire
+ **/
+void init_text_buffer(Text_Buffer *tb, int fd);
+
+/**
+ * Réserve de la place à la fin d'un tampon, pour y écrire directement ; le tampon est vidé
+ * (ou agrandi) si besoin. L'appelant ajoute ensuite à size le nombre d'octets écrits
+ *
+ * @param tb: un tampon initialisé
+ * @param n:  le nombre d'octets à réserver
+ * @retourne un pointeur sur la place réservée
+ **/
+char *reserve_text_buffer(Text_Buffer *tb, size_t n);
+
+/**
+ * Ajoute des caractères à un tampon
+ *
+ * @param tb: un tampon initialisé
+ * @param s:  les caractères à ajouter
+ * @param n:  le nombre de caractères
+ **/
+void append_chars(Text_Buffer *tb, const char *s, size_t n);
+
+/**
+ * Ajoute une chaîne à un tampon
+ *
+ * @param tb: un tampon initialisé
+ * @param s:  la chaîne à ajouter
+ **/
+void append_str(Text_Buffer *tb, const char *s);
+
+/**
+ * Ajoute un caractère à un tampon
+ *
+ * @param tb: un tampon initialisé
+ * @param c:  le caractère à ajouter
+ **/
+void append_char(Text_Buffer *tb, char c);
+
+/**
+ * Ajoute une chaîne complétée par des espaces jusqu'à une largeur donnée, comme "%*s" ;
+ * une largeur négative aligne à gauche, comme "%-*s". La chaîne n'est jamais tronquée
+ *
+ * @param tb:    un tampon initialisé
+ * @param s:     la chaîne à ajouter
+ * @param width: la largeur minimale
+ **/
+void append_padded(Text_Buffer *tb, const char *s, int width);
+
+/**
+ * Ajoute un nombre en hexadécimal, complété par des zéros jusqu'à un nombre de chiffres, comme "%0*x"
+ *
+ * @param tb:     un tampon initialisé
+ * @param value:  le nombre à ajouter
+ * @param digits: le nombre minimal de chiffres
+ **/
+void append_hex(Text_Buffer *tb, uint32_t value, int digits);
+
+/**
+ * Ajoute un nombre en décimal, complété par des espaces jusqu'à une largeur donnée, comme "%*i"
+ *
+ * @param tb:    un tampon initialisé
+ * @param value: le nombre à ajouter
+ * @param width: la largeur minimale
+ **/
+void append_dec(Text_Buffer *tb, int32_t value, int width);
+
+/**
+ * Ajoute un texte formaté comme avec printf ; réservé aux lignes qui ne sont pas répétées
+ *
+ * @param tb:     un tampon initialisé
+ * @param format: le format, comme pour printf
+ **/
+void append_format(Text_Buffer *tb, const char *format, ...);
+
+/**
+ * Ajoute un texte formaté comme avec vprintf
+ *
+ * @param tb:     un tampon initialisé
+ * @param format: le format, comme pour printf
+ * @param aptr:   les arguments du format
+ **/
+void append_vformat(Text_Buffer *tb, const char *format, va_list aptr);
+
+/**
+ * Écrit le contenu d'un tampon dans son fichier et le vide (sans effet en mémoire)
+ *
+ * @param tb: un tampon initialisé
+ * @retourne 0 en cas de succès, -1 si l'écriture a échoué
+ **/
+int flush_text_buffer(Text_Buffer *tb);
+
+/**
+ * Vide un tampon dans son fichier, puis libère sa mémoire
+ *
+ * @param tb: un tampon initialisé
+ **/
+void destroy_text_buffer(Text_Buffer *tb);
+
+
+#endif
@@ -0,0 +1,134 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "thread_pool.h"
+
+unsigned get_nb_cores(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (n > 0) ? (unsigned) n : 1;
+}
+
+static void *worker(void *arg)
+{
+	Thread_Pool *tp = arg;
+	Task task;
+
+	pthread_mutex_lock(&tp->lock);
+	for(;;)
+	{
+		while((tp->nb_tasks == 0) && !tp->stop)
+			pthread_cond_wait(&tp->has_task, &tp->lock);
+		if(tp->nb_tasks == 0)
+			break;
+
+		task = tp->tasks[tp->head];
+		tp->head = (tp->head + 1) % tp->capacity;
+		tp->nb_tasks--;
+
+		pthread_mutex_unlock(&tp->lock);
+		task.function(task.arg);
+		pthread_mutex_lock(&tp->lock);
+
+		if(--tp->pending == 0)
+			pthread_cond_broadcast(&tp->all_done);
+	}
+	pthread_mutex_unlock(&tp->lock);
+
+	return NULL;
+}
+
+Thread_Pool *create_thread_pool(unsigned nb_threads)
+{
+	Thread_Pool *tp = malloc(sizeof(Thread_Pool));
+
+	tp->nb_threads = (nb_threads > 1) ? nb_threads : 0;
+	tp->threads    = NULL;
+	tp->capacity   = 16;
+	tp->tasks      = malloc(sizeof(Task) * tp->capacity);
+	tp->head       = 0;
+	tp->nb_tasks   = 0;
+	tp->pending    = 0;
+	tp->stop       = 0;
+	if(tp->nb_threads == 0)
+		return tp;
+
+	pthread_mutex_init(&tp->lock, NULL);
+	pthread_cond_init(&tp->has_task, NULL);
+	pthread_cond_init(&tp->all_done, NULL);
+	tp->threads = malloc(sizeof(pthread_t) * tp->nb_threads);
+	for(unsigned i = 0; i < tp->nb_threads; i++)
+		if(pthread_create(&tp->threads[i], NULL, worker, tp))
+		{
+			/* On se contente des fils déjà créés */
+			tp->nb_threads = i;
+			break;
+		}
+
+	return tp;
+}
+
+static void grow_task_queue(Thread_Pool *tp)
+{
+	Task *tasks = malloc(sizeof(Task) * 2 * tp->capacity);
+
+	/* La file est circulaire : on remet les tâches dans l'ordre au début du nouveau bloc */
+	for(unsigned i = 0; i < tp->nb_tasks; i++)
+		tasks[i] = tp->tasks[(tp->head + i) % tp->capacity];
+	free(tp->tasks);
+	tp->tasks     = tasks;
+	tp->head      = 0;
+	tp->capacity *= 2;
+}
+
+void submit_task(Thread_Pool *tp, Task_Function function, void *arg)
+{
+	if(tp->nb_threads == 0)
+	{
+		function(arg);
+		return;
+	}
+
+	pthread_mutex_lock(&tp->lock);
+	if(tp->nb_tasks == tp->capacity)
+		grow_task_queue(tp);
+	tp->tasks[(tp->head + tp->nb_tasks) % tp->capacity] = (Task) { function, arg };
+	tp->nb_tasks++;
+	tp->pending++;
+	pthread_cond_signal(&tp->has_task);
+	pthread_mutex_unlock(&tp->lock);
+}
+
+void wait_thread_pool(Thread_Pool *tp)
+{
+	if(tp->nb_threads == 0)
+		return;
+
+	pthread_mutex_lock(&tp->lock);
+	while(tp->pending > 0)
+		pthread_cond_wait(&tp->all_done, &tp->lock);
+	pthread_mutex_unlock(&tp->lock);
+}
+
+void destroy_thread_pool(Thread_Pool *tp)
+{
+	if(tp->nb_threads > 0)
+	{
+		pthread_mutex_lock(&tp->lock);
+		tp->stop = 1;
+		pthread_cond_broadcast(&tp->has_task);
+		pthread_mutex_unlock(&tp->lock);
+
+		for(unsigned i = 0; i < tp->nb_threads; i++)
+			pthread_join(tp->threads[i], NULL);
+		pthread_mutex_destroy(&tp->lock);
+		pthread_cond_destroy(&tp->has_task);
+		pthread_cond_destroy(&tp->all_done);
+	}
+
+	free(tp->threads);
+	free(tp->tasks);
+	free(tp);
+}
@@ -0,0 +1,69 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <pthread.h>
+
+typedef void (*Task_Function)(void *arg);
+
+typedef struct
+{
+	Task_Function function; // Fonction à exécuter
+	void *arg;              // Argument passé à la fonction
+} Task;
+
+typedef struct
+{
+	unsigned nb_threads;      // Nombre de fils d'exécution (0 : les tâches sont exécutées à la soumission)
+	pthread_t *threads;       // Fils d'exécution du groupe
+	pthread_mutex_t lock;     // Protège la file des tâches
+	pthread_cond_t has_task;  // Signalé quand une tâche est ajoutée ou que le groupe s'arrête
+	pthread_cond_t all_done;  // Signalé quand toutes les tâches soumises sont terminées
+	Task *tasks;              // File des tâches en attente
+	unsigned head, nb_tasks;  // Indice de la prochaine tâche et nombre de tâches dans la file
+	unsigned capacity;        // Nombre de tâches pouvant être stockées dans tasks sans réallocation
+	unsigned pending;         // Nombre de tâches soumises et pas encore terminées
+	int stop;                 // Vaut 1 quand le groupe doit s'arrêter
+} Thread_Pool;
+
+/**
+ * Retourne le nombre de cœurs disponibles sur la machine
+ *
+ * @retourne le nombre de cœurs (au moins 1)
+ **/
+unsigned get_nb_cores(void);
+
+/**
+ * Crée un groupe de fils d'exécution
+ *
+ * @param nb_threads: le nombre de fils d'exécution ; avec 0 ou 1, les tâches sont exécutées
+ *                    directement par le fil appelant, dans l'ordre de soumission
+ * @retourne un pointeur sur une structure de type Thread_Pool
+ **/
+Thread_Pool *create_thread_pool(unsigned nb_threads);
+
+/**
+ * Soumet une tâche au groupe de fils d'exécution
+ *
+ * @param tp:       une structure de type Thread_Pool initialisée
+ * @param function: la fonction à exécuter
+ * @param arg:      l'argument passé à la fonction
+ **/
+void submit_task(Thread_Pool *tp, Task_Function function, void *arg);
+
+/**
+ * Attend la fin de toutes les tâches soumises
+ *
+ * @param tp: une structure de type Thread_Pool initialisée
+ **/
+void wait_thread_pool(Thread_Pool *tp);
+
+/**
+ * Attend la fin des tâches soumises, arrête les fils d'exécution et libère la mémoire
+ * occupée par une structure Thread_Pool
+ *
+ * @param tp: une structure de type Thread_Pool initialisée
+ **/
+void destroy_thread_pool(Thread_Pool *tp);
+
+
+#endif
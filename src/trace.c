@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "trace.h"
+
+unsigned char trace_levels[TRACE_CATEGORIES];
+
+static const char *category_names[TRACE_CATEGORIES] = { "sections", "symbols", "relocs", "io" };
+
+/* Les traces sont rassemblées dans un tampon vidé sur la sortie d'erreur */
+static Text_Buffer sink;
+static pthread_mutex_t sink_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Retourne 0 si la valeur n'est pas une liste de niveaux valide */
+static int parse_trace_levels(const char *env)
+{
+	const char *p = env;
+	size_t len, name_len;
+	const char *eq;
+	int level, c;
+
+	if(*p == '\0')
+		return 0;
+
+	while(*p != '\0')
+	{
+		len      = strcspn(p, ",");
+		eq       = memchr(p, '=', len);
+		name_len = (eq != NULL) ? (size_t) (eq - p) : len;
+		level    = (eq != NULL) ? atoi(eq + 1) : TRACE_DETAIL;
+
+		/* Un nombre seul active tout le détail, comme l'ancien DEBUG_FUSION=1 ; 0 désactive tout */
+		if((eq == NULL) && isdigit((unsigned char) p[0]))
+			memset(trace_levels, (atoi(p) > 0) ? TRACE_DETAIL : 0, TRACE_CATEGORIES);
+		else
+		{
+			for(c = 0; (c < TRACE_CATEGORIES) && ((strlen(category_names[c]) != name_len) || strncmp(p, category_names[c], name_len)); c++);
+			if(c == TRACE_CATEGORIES)
+				return 0;
+			trace_levels[c] = level;
+		}
+
+		p += len;
+		if(*p == ',')
+			p++;
+	}
+	return 1;
+}
+
+void init_trace(void)
+{
+	const char *env = getenv("DEBUG_FUSION");
+
+	memset(trace_levels, 0, TRACE_CATEGORIES);
+	if(env == NULL)
+		return;
+	if(!parse_trace_levels(env))
+		memset(trace_levels, TRACE_DETAIL, TRACE_CATEGORIES);
+
+	init_text_buffer(&sink, STDERR_FILENO);
+	atexit(flush_trace);
+}
+
+void trace_printf(const char *format, ...)
+{
+	va_list aptr;
+
+	pthread_mutex_lock(&sink_lock);
+	va_start(aptr, format);
+	append_vformat(&sink, format, aptr);
+	va_end(aptr);
+	pthread_mutex_unlock(&sink_lock);
+}
+
+Text_Buffer *get_trace_sink(void)
+{
+	pthread_mutex_lock(&sink_lock);
+	return &sink;
+}
+
+void release_trace_sink(void)
+{
+	pthread_mutex_unlock(&sink_lock);
+}
+
+void flush_trace(void)
+{
+	pthread_mutex_lock(&sink_lock);
+	if(sink.data != NULL)
+		flush_text_buffer(&sink);
+	pthread_mutex_unlock(&sink_lock);
+}
@@ -0,0 +1,69 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include "text_buffer.h"
+
+/* Niveau de trace maximal compilé : les traces de niveau supérieur disparaissent du programme
+ * (-DTRACE_MAX_LEVEL=0 retire toutes les traces) */
+#ifndef TRACE_MAX_LEVEL
+#define TRACE_MAX_LEVEL 2
+#endif
+
+/* Niveaux de trace */
+#define TRACE_STEPS  1 // Étapes et bilans
+#define TRACE_DETAIL 2 // Chaque section, symbole ou réimplantation traité
+
+typedef enum
+{
+	TRACE_SECTIONS,
+	TRACE_SYMBOLS,
+	TRACE_RELOCS,
+	TRACE_IO,
+	TRACE_CATEGORIES
+} Trace_Category;
+
+/* Niveau de trace de chaque catégorie, lu une seule fois par init_trace (0 : aucune trace) */
+extern unsigned char trace_levels[TRACE_CATEGORIES];
+
+/* Vrai si les traces d'une catégorie à un niveau donné sont affichées */
+#define trace_enabled(cat, level) (((level) <= TRACE_MAX_LEVEL) && (trace_levels[cat] >= (level)))
+
+/* Les arguments ne sont évalués que si la trace est affichée */
+#define TRACE(cat, level, ...) \
+	do { if(trace_enabled(cat, level)) trace_printf(__VA_ARGS__); } while(0)
+
+/**
+ * Lit les niveaux de trace dans la variable d'environnement DEBUG_FUSION : une liste séparée par
+ * des virgules de "N" (0 : aucune trace, sinon tout le détail de toutes les catégories),
+ * "catégorie" (niveau maximal) ou "catégorie=N", avec les catégories sections, symbols, relocs
+ * et io. Toute autre valeur active toutes les traces. Les traces sont écrites sur la sortie d'erreur, par blocs
+ **/
+void init_trace(void);
+
+/**
+ * Ajoute une trace formatée comme avec printf au tampon des traces
+ *
+ * @param format: le format, comme pour printf
+ **/
+void trace_printf(const char *format, ...);
+
+/**
+ * Retourne le tampon des traces, pour y écrire directement ; l'appelant doit le rendre
+ * avec release_trace_sink
+ *
+ * @retourne le tampon des traces
+ **/
+Text_Buffer *get_trace_sink(void);
+
+/**
+ * Rend le tampon des traces obtenu avec get_trace_sink
+ **/
+void release_trace_sink(void);
+
+/**
+ * Écrit les traces en attente
+ **/
+void flush_trace(void);
+
+
+#endif
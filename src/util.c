@@ -29,44 +29,7 @@ Contact: Guillaume.Huard@imag.fr
 #include <unistd.h>
 
 
-int elf32_is_big = 0;
-
 int is_big_endian() {
     static uint32_t one = 1;
     return ((* (uint8_t *) &one) == 0);
 }
-
-ssize_t __wrap_read(int fildes, void *buf, size_t nbyte)
-{
-        ssize_t r = __real_read(fildes, buf, nbyte);
-
-        if((is_big_endian() && !elf32_is_big) || (!is_big_endian() && elf32_is_big))
-        {
-                if(nbyte == sizeof(uint32_t))
-                {
-                        uint32_t tmp1 = *((uint32_t*) buf);
-                        uint32_t *tmp2 = (uint32_t*) buf;
-                        *tmp2 = reverse_4(tmp1);
-                }
-                else if(nbyte == sizeof(uint16_t))
-                {
-                        uint16_t tmp1 = *((uint16_t*) buf);
-                        uint16_t *tmp2 = (uint16_t*) buf;
-                        *tmp2 = reverse_2(tmp1);
-                }
-        }
-
-        return r;
-}
-
-int print_debug(const char *format, ...)
-{
-	if(getenv("DEBUG_FUSION") == NULL)
-		return 0;
-
-	va_list aptr;
-	va_start(aptr, format);
-	int ret = vprintf(format, aptr);
-	va_end(aptr);
-	return ret;
-}
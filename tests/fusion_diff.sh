@@ -2,7 +2,7 @@
 
 DIR=$(dirname $0)
 
-$DIR/../fusion $1 $2 $3
+$DIR/../fusion $3 $1 $2
 readelf -h -S -s -r prog.o > /tmp/fusion_project.txt
 
 arm-none-eabi-ld -r -o $3 $1 $2
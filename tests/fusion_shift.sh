@@ -0,0 +1,120 @@
+#!/bin/bash
+#
+# Compare fusion à "ld -r" sur deux objets dont le second a ses sections décalées par la fusion :
+# ses réimplantations portant sur des symboles de section doivent voir leur valeur ajoutée corrigée.
+# Chaque machine est testée si son assembleur et son éditeur de liens sont installés :
+#   i386 (REL), x32 (RELA) et ARM (REL, arm-none-eabi-as et arm-none-eabi-ld)
+# Retourne 0 si toutes les machines testées donnent le même résultat que ld -r
+
+DIR=$(cd $(dirname $0) && pwd)
+FUSION=${FUSION:-$DIR/../fusion}
+TMP=$(mktemp -d)
+trap "rm -rf $TMP" EXIT
+failed=0
+
+# Réimplantations (sans la colonne Info, qui dépend de l'ordre des symboles) et contenu des sections
+dump()
+{
+	readelf -W -r $1 | awk '/^Relocation section/ { s = $3 } /^[0-9a-f]+ / { $2 = ""; print s, $0 }' | sort
+	for sec in .text .text.f .data
+	do
+		readelf -W -x $sec $1 | grep -v "^ *$"
+	done
+}
+
+# test NOM AS LD : assemble $TMP/NOM_a.s et $TMP/NOM_b.s, fusionne et compare
+run_test()
+{
+	local name=$1 as=$2 ld=$3
+
+	if ! $as $TMP/${name}_a.s -o $TMP/${name}_a.o 2>/dev/null || ! $as $TMP/${name}_b.s -o $TMP/${name}_b.o 2>/dev/null
+	then
+		echo "$name : ignoré (assembleur absent)"
+		return
+	fi
+	if ! $ld -r $TMP/${name}_a.o $TMP/${name}_b.o -o $TMP/${name}_ld.o 2>/dev/null
+	then
+		echo "$name : ignoré (éditeur de liens absent)"
+		return
+	fi
+	$FUSION $TMP/${name}_fusion.o $TMP/${name}_a.o $TMP/${name}_b.o
+	dump $TMP/${name}_fusion.o > $TMP/${name}_fusion.txt
+	dump $TMP/${name}_ld.o     > $TMP/${name}_ld.txt
+	if diff -u $TMP/${name}_ld.txt $TMP/${name}_fusion.txt
+	then
+		echo "$name : OK"
+	else
+		echo "$name : ÉCHEC"
+		failed=1
+	fi
+}
+
+# i386 : R_386_32 et R_386_PC32 sur les symboles de section .data et .text.f du second fichier
+cat > $TMP/i386_a.s <<EOF
+	.text
+	.globl f1
+f1:	movl $.La, %eax
+	call .Lfa
+	ret
+	.section .text.f, "ax"
+.Lfa:	ret
+	.data
+	.long 1, 2, 3
+.La:	.long 4
+EOF
+cat > $TMP/i386_b.s <<EOF
+	.text
+	.globl f2
+f2:	movl $.Lb, %eax
+	movl $.Lb+4, %ecx
+	call .Lfb
+	call f1
+	ret
+	.section .text.f, "ax"
+	nop
+.Lfb:	ret
+	.data
+	.long 5
+.Lb:	.long 6, .Lb
+EOF
+run_test i386 "as --32" "ld -m elf_i386"
+
+# x32 : la valeur ajoutée est explicite (RELA)
+cp $TMP/i386_a.s $TMP/x32_a.s
+cp $TMP/i386_b.s $TMP/x32_b.s
+run_test x32 "as --x32" "ld -m elf32_x86_64"
+
+# ARM : R_ARM_ABS32, R_ARM_ABS16, R_ARM_ABS8 et R_ARM_CALL sur les symboles de section du second fichier
+cat > $TMP/arm_a.s <<EOF
+	.text
+	.globl f1
+f1:	bl .Lfa
+	bx lr
+	.word .La
+	.section .text.f, "ax"
+.Lfa:	bx lr
+	.data
+	.word 1, 2, 3
+.La:	.word 4
+EOF
+cat > $TMP/arm_b.s <<EOF
+	.text
+	.globl f2
+f2:	bl .Lfb
+	bl f1
+	bx lr
+	.word .Lb
+	.word .Lb+4
+	.hword .Lb
+	.byte .Lb
+	.align 2
+	.section .text.f, "ax"
+	nop
+.Lfb:	bx lr
+	.data
+	.word 5
+.Lb:	.word 6, .Lb
+EOF
+run_test arm "arm-none-eabi-as" "arm-none-eabi-ld"
+
+exit $failed